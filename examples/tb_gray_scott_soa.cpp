@@ -0,0 +1,157 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D Gray-Scott reaction-diffusion, Periodic version, on an
+ * array of structs in the structure-of-arrays layout (Pochoir_SoA_Layout())
+ * against the same stencil on an array of the plain struct
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 2
+#define TOLERANCE (1e-9)
+
+#define DU (0.16)
+#define DV (0.08)
+#define FEED (0.035)
+#define KILL (0.065)
+
+/* u and v are the concentrations, 'hot' counts the time steps in which
+ * v exceeded 0.25, so that a field of another type shares the last word
+ */
+typedef struct
+{
+    double u;
+    double v;
+    int hot;
+} CELL;
+
+/* the same fields, every field in its own plane */
+typedef struct
+{
+    double u;
+    double v;
+    int hot;
+} SOA_CELL;
+
+Pochoir_SoA_Layout(SOA_CELL);
+
+int check_result(int t, int j, int i, char const * field, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d).%s == b(%d, %d, %d).%s == %f : passed!\n", t, j, i, field, t, j, i, field, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d).%s = %f, b(%d, %d, %d).%s = %f : FAILED!\n", t, j, i, field, a, t, j, i, field, b);
+        return 1;
+	}
+
+}
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    Pochoir_Shape_2D gs_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> gs_2D(gs_shape_2D), soa_gs_2D(gs_shape_2D);
+	Pochoir_Boundary_Array_2D(CELL, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE);
+	Pochoir_Boundary_Array_2D(SOA_CELL, Pochoir_Boundary_Periodic) b(N_SIZE, N_SIZE);
+    gs_2D.Register_Array(a);
+
+    soa_gs_2D.Register_Array(b);
+
+    /* u = 1, v = 0, but for a few seeds */
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        bool seed = (rand() % 16 == 0);
+        a(0, i, j).u = seed ? 0.5 : 1.0;
+        a(0, i, j).v = seed ? 0.25 + 1.0 * (rand() % BASE) / (4 * BASE) : 0.0;
+        a(0, i, j).hot = 0;
+        b(0, i, j).u = a(0, i, j).u;
+        b(0, i, j).v = a(0, i, j).v;
+        b(0, i, j).hot = a(0, i, j).hot;
+	} }
+
+    Pochoir_Kernel_2D(gs_2D_fn, t, i, j)
+        double u = a(t-1, i, j).u, v = a(t-1, i, j).v;
+        double uvv = u * v * v;
+	    a(t, i, j).u = u + DU * (a(t-1, i+1, j).u + a(t-1, i-1, j).u + a(t-1, i, j+1).u + a(t-1, i, j-1).u - 4.0 * u) - uvv + FEED * (1.0 - u);
+	    a(t, i, j).v = v + DV * (a(t-1, i+1, j).v + a(t-1, i-1, j).v + a(t-1, i, j+1).v + a(t-1, i, j-1).v - 4.0 * v) + uvv - (FEED + KILL) * v;
+        a(t, i, j).hot = a(t-1, i, j).hot + (v > 0.25 ? 1 : 0);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(soa_gs_2D_fn, t, i, j)
+        double u = b(t-1, i, j).u, v = b(t-1, i, j).v;
+        double uvv = u * v * v;
+	    b(t, i, j).u = u + DU * (b(t-1, i+1, j).u + b(t-1, i-1, j).u + b(t-1, i, j+1).u + b(t-1, i, j-1).u - 4.0 * u) - uvv + FEED * (1.0 - u);
+	    b(t, i, j).v = v + DV * (b(t-1, i+1, j).v + b(t-1, i-1, j).v + b(t-1, i, j+1).v + b(t-1, i, j-1).v - 4.0 * v) + uvv - (FEED + KILL) * v;
+        b(t, i, j).hot = b(t-1, i, j).hot + (v > 0.25 ? 1 : 0);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        gs_2D.Run(T_SIZE, gs_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (array of structs) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        soa_gs_2D.Run(T_SIZE, soa_gs_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (structure of arrays) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        CELL l_a = a.interior(t, i, j);
+        SOA_CELL l_b = b.interior(t, i, j);
+		failed += check_result(t, i, j, "u", l_a.u, l_b.u);
+		failed += check_result(t, i, j, "v", l_a.v, l_b.v);
+		failed += check_result(t, i, j, "hot", l_a.hot, l_b.hot);
+	} } 
+    printf("compare a with b : %s\n", failed ? "FAILED!" : "passed!");
+
+	return failed != 0;
+}
@@ -0,0 +1,189 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, built-in boundaries : an array with
+ * each of the policies Pochoir_Boundary_Periodic, _Clamp, _Mirror, _Zero
+ * and _Constant against the same boundary written as a user
+ * Pochoir_Boundary_2D function. The two runs alternate TIMES times, and
+ * the fastest of each is reported.
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 5
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+#define CONST_VALUE (3.5)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %f : passed!\n", t, j, i, t, j, i, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+
+}
+
+Pochoir_Boundary_2D(periodic_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (i - arr_size_1) : (i < 0 ? i + arr_size_1 : i);
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+Pochoir_Boundary_2D(clamp_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (arr_size_1 - 1) : (i < 0 ? 0 : i);
+    int new_j = (j >= arr_size_0) ? (arr_size_0 - 1) : (j < 0 ? 0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+/* reflects about the edge of the grid : -1 -> 0, N -> N-1 */
+Pochoir_Boundary_2D(mirror_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (2 * arr_size_1 - 1 - i) : (i < 0 ? -1 - i : i);
+    int new_j = (j >= arr_size_0) ? (2 * arr_size_0 - 1 - j) : (j < 0 ? -1 - j : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+Pochoir_Boundary_2D(zero_2D, arr, t, i, j)
+    return 0;
+Pochoir_Boundary_End
+
+Pochoir_Boundary_2D(const_2D, arr, t, i, j)
+    return CONST_VALUE;
+Pochoir_Boundary_End
+
+/* the value of the Pochoir_Boundary_Constant arrays */
+template <typename T_Boundary>
+void register_constant(Pochoir_Boundary_Array_2D(double, T_Boundary) & a) { }
+
+void register_constant(Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Constant) & a)
+{
+    a.Register_Boundary(pochoir_boundary_constant(CONST_VALUE));
+}
+
+/* runs the heat equation on a with the built-in boundary T_Boundary,
+ * and on b with the user boundary function _user, 
+ * returns the # of points that differ at T_SIZE
+ */
+template <typename T_Boundary>
+int run_heat(char const * _name, int N_SIZE, int T_SIZE, double (*_user)(Pochoir_Array<double, N_RANK> &, int, int, int))
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    double builtin_time = 0, user_time = 0;
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), user_heat_2D(heat_shape_2D);
+	Pochoir_Boundary_Array_2D(double, T_Boundary) a(N_SIZE, N_SIZE);
+	Pochoir_Array<double, N_RANK> b(N_SIZE, N_SIZE);
+    register_constant(a);
+    heat_2D.Register_Array(a);
+    b.Register_Boundary(_user);
+    user_heat_2D.Register_Array(b);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        b(0, i, j) = a(0, i, j);
+        b(1, i, j) = 0;
+	} }
+
+    printf("%s boundary :\n", _name);
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(user_heat_2D_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+    /* both arrays take the same TIMES runs, so they still agree at the end */
+    for (int times = 0; times < TIMES; ++times) {
+        gettimeofday(&start, 0);
+        heat_2D.Run(T_SIZE, heat_2D_fn);
+        gettimeofday(&end, 0);
+        if (times == 0 || tdiff(&end, &start) < builtin_time)
+            builtin_time = tdiff(&end, &start);
+
+        gettimeofday(&start, 0);
+        user_heat_2D.Run(T_SIZE, user_heat_2D_fn);
+        gettimeofday(&end, 0);
+        if (times == 0 || tdiff(&end, &start) < user_time)
+            user_time = tdiff(&end, &start);
+    }
+	std::cout << "Pochoir (built-in boundary) : consumed time :" << 1.0e3 * builtin_time << "ms" << std::endl;
+	std::cout << "Pochoir (user boundary) : consumed time :" << 1.0e3 * user_time << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		failed += check_result(t, i, j, a.interior(t, i, j), b.interior(t, i, j));
+	} } 
+    printf("compare a with b : %s\n", failed ? "FAILED!" : "passed!");
+    return failed;
+}
+
+int main(int argc, char * argv[])
+{
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+
+    int failed = run_heat<Pochoir_Boundary_Periodic>("Periodic", N_SIZE, T_SIZE, periodic_2D);
+    failed += run_heat<Pochoir_Boundary_Clamp>("Clamp", N_SIZE, T_SIZE, clamp_2D);
+    failed += run_heat<Pochoir_Boundary_Mirror>("Mirror", N_SIZE, T_SIZE, mirror_2D);
+    failed += run_heat<Pochoir_Boundary_Zero>("Zero", N_SIZE, T_SIZE, zero_2D);
+    failed += run_heat<Pochoir_Boundary_Constant>("Constant", N_SIZE, T_SIZE, const_2D);
+
+	return failed != 0;
+}
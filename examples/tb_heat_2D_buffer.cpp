@@ -0,0 +1,136 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, Periodic version on a user buffer : an
+ * array adopting a buffer of the application with Register_Buffer(),
+ * initialized and read back in place, against the array on the heap,
+ * whose storage is handed over with Detach_Buffer()
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %f : passed!\n", t, j, i, t, j, i, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+
+}
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), buf_heat_2D(heat_shape_2D);
+	Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE), b(N_SIZE, N_SIZE);
+
+    /* the shape reaches back one time step : two levels of N_SIZE x N_SIZE,
+     * time step t in level (t & 1)
+     */
+    const long l_level = (long)N_SIZE * N_SIZE;
+    double * buf = (double *) malloc(2 * l_level * sizeof(double));
+    if (buf == NULL) {
+        printf("malloc() of the buffer failed, quit! \n");
+        exit(1);
+    }
+    a.Register_Buffer(buf, 2);
+    buf_heat_2D.Register_Array(a);
+
+    heat_2D.Register_Array(b);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        buf[i * N_SIZE + j] = 1.0 * (rand() % BASE); 
+        buf[l_level + i * N_SIZE + j] = 0; 
+        b(0, i, j) = buf[i * N_SIZE + j];
+        b(1, i, j) = 0;
+	} }
+
+	cout << "a(T+1, J, I) = 0.125 * (a(T, J+1, I) - 2.0 * a(T, J, I) + a(T, J-1, I)) + 0.125 * (a(T, J, I+1) - 2.0 * a(T, J, I) + a(T, J, I-1)) + a(T, J, I)" << endl;
+    Pochoir_Kernel_2D(buf_heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        buf_heat_2D.Run(T_SIZE, buf_heat_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (user buffer) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        heat_2D.Run(T_SIZE, heat_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (heap) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+    /* b keeps using its storage, but it is ours to free from now on */
+    double * l_b = b.Detach_Buffer();
+    const long l_b_level = b.total_size();
+    const long l_b_stride = b.stride(1);
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		failed += check_result(t, i, j, buf[(t & 1) * l_level + i * N_SIZE + j], b.interior(t, i, j));
+		failed += check_result(t, i, j, a.interior(t, i, j), l_b[(t & b.slot_mask()) * l_b_level + i * l_b_stride + j]);
+	} } 
+    printf("compare a with b : %s\n", failed ? "FAILED!" : "passed!");
+
+    free(l_b);
+    free(buf);
+	return failed != 0;
+}
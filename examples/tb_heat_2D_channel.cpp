@@ -0,0 +1,150 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation in a channel : periodic along j, walls
+ * held at 0 along i. The run with dimension 1 marked POCHOIR_DIM_OPEN,
+ * whose zoids never wrap around the walls, against the run with the
+ * default (all periodic) topology and the naive loop
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %f : passed!\n", t, j, i, t, j, i, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+
+}
+
+Pochoir_Boundary_2D(channel_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    if (i < 0 || i >= arr_size_1)
+        return 0;
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, i, new_j);
+Pochoir_Boundary_End
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), channel_heat_2D(heat_shape_2D);
+	Pochoir_Array<double, N_RANK> a(N_SIZE, N_SIZE), b(N_SIZE, N_SIZE), c(N_SIZE, N_SIZE);
+    a.Register_Boundary(channel_2D);
+    channel_heat_2D.Register_Array(a);
+
+    b.Register_Boundary(channel_2D);
+    heat_2D.Register_Array(b);
+
+    c.Register_Shape(heat_shape_2D);
+    c.Register_Boundary(channel_2D);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        b(0, i, j) = a(0, i, j);
+        b(1, i, j) = 0;
+        c(0, i, j) = a(0, i, j);
+        c(1, i, j) = 0;
+	} }
+
+	cout << "a(T+1, J, I) = 0.125 * (a(T, J+1, I) - 2.0 * a(T, J, I) + a(T, J-1, I)) + 0.125 * (a(T, J, I+1) - 2.0 * a(T, J, I) + a(T, J, I-1)) + a(T, J, I)" << endl;
+    Pochoir_Kernel_2D(channel_heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+    /* dimension 1 is i, the first index of the array */
+    Pochoir_Policy channel_policy;
+    channel_policy.dim_topology[1] = POCHOIR_DIM_OPEN;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        channel_heat_2D.Run(T_SIZE, channel_heat_2D_fn, channel_policy);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (open i) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        heat_2D.Run(T_SIZE, heat_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (periodic i) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+	for (int t = 0; t < T_SIZE; ++t) {
+    cilk_for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        c(t+1, i, j) = 0.125 * (c(t, i+1, j) - 2.0 * c(t, i, j) + c(t, i-1, j)) + 0.125 * (c(t, i, j+1) - 2.0 * c(t, i, j) + c(t, i, j-1)) + c(t, i, j); } } }
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Naive Loop: consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		failed += check_result(t, i, j, a.interior(t, i, j), b.interior(t, i, j));
+		failed += check_result(t, i, j, a.interior(t, i, j), c.interior(t, i, j));
+	} } 
+    printf("compare a with b and c : %s\n", failed ? "FAILED!" : "passed!");
+
+	return failed != 0;
+}
@@ -0,0 +1,142 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, Periodic version with halo : an array
+ * with the built-in periodic boundary and halo cells, run on the whole
+ * domain by an obase kernel through interior(), against the heap array
+ * with the periodic_2D boundary function run by Run()
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 2
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %f : passed!\n", t, j, i, t, j, i, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+
+}
+
+Pochoir_Boundary_2D(periodic_2D, arr, t, i, j)
+    const int arr_size_1 = arr.size(1);
+    const int arr_size_0 = arr.size(0);
+
+    int new_i = (i >= arr_size_1) ? (i - arr_size_1) : (i < 0 ? i + arr_size_1 : i);
+    int new_j = (j >= arr_size_0) ? (j - arr_size_0) : (j < 0 ? j + arr_size_0 : j);
+
+    return arr.get(t, new_i, new_j);
+Pochoir_Boundary_End
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), halo_heat_2D(heat_shape_2D);
+	Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE);
+	Pochoir_Array<double, N_RANK> b(N_SIZE, N_SIZE);
+    /* the halo is as wide as the shape reaches, one point on each side */
+    a.Register_Halo();
+    halo_heat_2D.Register_Array(a);
+
+    b.Register_Boundary(periodic_2D);
+    heat_2D.Register_Array(b);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        b(0, i, j) = a(0, i, j);
+        b(1, i, j) = 0;
+	} }
+
+	cout << "a(T+1, J, I) = 0.125 * (a(T, J+1, I) - 2.0 * a(T, J, I) + a(T, J-1, I)) + 0.125 * (a(T, J, I+1) - 2.0 * a(T, J, I) + a(T, J, I-1)) + a(T, J, I)" << endl;
+    /* no boundary kernel : on the faces interior() reads the halo cells */
+    Pochoir_Obase_Fn_2D(halo_heat_2D_fn, t0, t1, grid)
+        grid_info<N_RANK> l_grid = grid;
+        for (int t = t0; t < t1; ++t) {
+            for (int i = l_grid.x0[1]; i < l_grid.x1[1]; ++i) {
+            for (int j = l_grid.x0[0]; j < l_grid.x1[0]; ++j) {
+	            a.interior(t, i, j) = 0.125 * (a.interior(t-1, i+1, j) - 2.0 * a.interior(t-1, i, j) + a.interior(t-1, i-1, j)) + 0.125 * (a.interior(t-1, i, j+1) - 2.0 * a.interior(t-1, i, j) + a.interior(t-1, i, j-1)) + a.interior(t-1, i, j);
+            } }
+            for (int q = 0; q < N_RANK; ++q) {
+                l_grid.x0[q] += l_grid.dx0[q];
+                l_grid.x1[q] += l_grid.dx1[q];
+            }
+        }
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        halo_heat_2D.Run_Obase(T_SIZE, halo_heat_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (halo) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        heat_2D.Run(T_SIZE, heat_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (boundary function) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		failed += check_result(t, i, j, a.interior(t, i, j), b.interior(t, i, j));
+	} } 
+    printf("compare a with b : %s\n", failed ? "FAILED!" : "passed!");
+
+	return failed != 0;
+}
@@ -0,0 +1,180 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D heat equation, Run_Until() and Advance() : the same
+ * T_SIZE time steps as one Run() on a, as windows of EVERY steps by
+ * Run() and Advance() on b with cache_plan replaying the zoids, and by
+ * Run_Until() on c with a fused max-residual that stops half way, then
+ * Advance() to T_SIZE. All three must match a serial sweep exactly, and
+ * the residual of each window must match the one of the serial sweep.
+ * Build with -fopenmp -DPOCHOIR_BACKEND=POCHOIR_BACKEND_OPENMP or
+ * -DPOCHOIR_BACKEND=POCHOIR_BACKEND_SERIAL for the other backends.
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+#include <vector>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define N_RANK 2
+
+int check_result(int t, int j, int i, double a, double b)
+{
+	if (a == b) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %f : passed!\n", t, j, i, t, j, i, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %f, b(%d, %d, %d) = %f : FAILED!\n", t, j, i, a, t, j, i, b);
+        return 1;
+	}
+
+}
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    int N_SIZE = 0, T_SIZE = 0, EVERY = 10;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    if (argc > 3)
+        EVERY = StrToInt(argv[3]);
+    printf("N_SIZE = %d, T_SIZE = %d, EVERY = %d\n", N_SIZE, T_SIZE, EVERY);
+    Pochoir_Shape_2D heat_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, 0, 0}, {-1, -1, 0}, {-1, 0, -1}, {-1, 0, 1}};
+    Pochoir<N_RANK> heat_2D(heat_shape_2D), win_heat_2D(heat_shape_2D), until_heat_2D(heat_shape_2D);
+	Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE), b(N_SIZE, N_SIZE), c(N_SIZE, N_SIZE), d(N_SIZE, N_SIZE);
+    heat_2D.Register_Array(a);
+    win_heat_2D.Register_Array(b);
+    until_heat_2D.Register_Array(c);
+    d.Register_Shape(heat_shape_2D);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        a(0, i, j) = 1.0 * (rand() % BASE); 
+        a(1, i, j) = 0; 
+        b(0, i, j) = c(0, i, j) = d(0, i, j) = a(0, i, j);
+        b(1, i, j) = c(1, i, j) = d(1, i, j) = 0;
+	} }
+
+    Pochoir_Kernel_2D(heat_2D_fn, t, i, j)
+	    a(t, i, j) = 0.125 * (a(t-1, i+1, j) - 2.0 * a(t-1, i, j) + a(t-1, i-1, j)) + 0.125 * (a(t-1, i, j+1) - 2.0 * a(t-1, i, j) + a(t-1, i, j-1)) + a(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(win_heat_2D_fn, t, i, j)
+	    b(t, i, j) = 0.125 * (b(t-1, i+1, j) - 2.0 * b(t-1, i, j) + b(t-1, i-1, j)) + 0.125 * (b(t-1, i, j+1) - 2.0 * b(t-1, i, j) + b(t-1, i, j-1)) + b(t-1, i, j);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_2D(until_heat_2D_fn, t, i, j)
+	    c(t, i, j) = 0.125 * (c(t-1, i+1, j) - 2.0 * c(t-1, i, j) + c(t-1, i-1, j)) + 0.125 * (c(t-1, i, j+1) - 2.0 * c(t-1, i, j) + c(t-1, i, j-1)) + c(t-1, i, j);
+    Pochoir_Kernel_End
+
+    /* how far the last time step of a window moved each point */
+    Pochoir_Kernel_2D(res_fn, t, i, j)
+        return fabs(c(t, i, j) - c(t-1, i, j));
+    Pochoir_Kernel_End
+
+    /* the serial sweep, and the residual at the end of each window */
+    vector<double> res;
+	gettimeofday(&start, 0);
+	for (int t = 0; t < T_SIZE; ++t) {
+        double l_res = 0;
+    for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+        d(t+1, i, j) = 0.125 * (d(t, i+1, j) - 2.0 * d(t, i, j) + d(t, i-1, j)) + 0.125 * (d(t, i, j+1) - 2.0 * d(t, i, j) + d(t, i, j-1)) + d(t, i, j);
+        l_res = max(l_res, fabs(d(t+1, i, j) - d(t, i, j))); } }
+        if ((t + 1) % EVERY == 0 || t + 1 == T_SIZE)
+            res.push_back(l_res);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Naive Loop: consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+	gettimeofday(&start, 0);
+    heat_2D.Run(T_SIZE, heat_2D_fn);
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (Run) : consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+    /* the windows of the same length replay the recorded plan */
+    Pochoir_Policy l_policy;
+    l_policy.cache_plan = true;
+	gettimeofday(&start, 0);
+    win_heat_2D.Run(min(EVERY, T_SIZE), win_heat_2D_fn, l_policy);
+    while (win_heat_2D.Time() < T_SIZE)
+        win_heat_2D.Advance(min(EVERY, T_SIZE - win_heat_2D.Time()), win_heat_2D_fn, l_policy);
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (Run + Advance) : consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+    /* stop at the first window whose residual is at most the one half
+     * way through the serial sweep
+     */
+    const double eps = res[(res.size() - 1) / 2];
+    int stop = T_SIZE;
+    for (int w = 0; w < (int)res.size(); ++w) {
+        if (res[w] <= eps) {
+            stop = min((w + 1) * EVERY, T_SIZE);
+            break;
+        }
+    }
+    vector<double> until_res;
+    auto res_max = pochoir_reduce_max<double>(res_fn);
+    until_heat_2D.Register_Policy(l_policy);
+	gettimeofday(&start, 0);
+    int steps = until_heat_2D.Run_Until(EVERY, T_SIZE, until_heat_2D_fn, res_max, [&](double r) { until_res.push_back(r); return r <= eps; });
+    until_heat_2D.Advance(T_SIZE - steps, until_heat_2D_fn);
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (Run_Until + Advance) : consumed time :" << 1.0e3 * tdiff(&end, &start) << "ms" << std::endl;
+
+    int failed = 0;
+    if (steps != stop) {
+        printf("Run_Until() stopped after %d time steps instead of %d : FAILED!\n", steps, stop);
+        ++failed;
+    }
+    for (int w = 0; w < (int)until_res.size(); ++w) {
+        if (w >= (int)res.size() || until_res[w] != res[w]) {
+            printf("residual of window %d = %g, serial = %g : FAILED!\n", w, until_res[w], w < (int)res.size() ? res[w] : 0.0);
+            ++failed;
+        }
+    }
+
+	t = T_SIZE;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+		failed += check_result(t, i, j, a.interior(t, i, j), d.interior(t, i, j));
+		failed += check_result(t, i, j, b.interior(t, i, j), d.interior(t, i, j));
+		failed += check_result(t, i, j, c.interior(t, i, j), d.interior(t, i, j));
+	} } 
+    printf("compare a, b and c with d : %s\n", failed ? "FAILED!" : "passed!");
+
+	return failed != 0;
+}
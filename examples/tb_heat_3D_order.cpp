@@ -0,0 +1,155 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 3D heat equation, Periodic version, storage order : an
+ * array stored in tiles (Register_Tiling()) and one stored in Z-order
+ * (Register_Morton()) against the row-major array
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+/* tiled and Morton arrays are indexed through the map tables */
+#ifndef POCHOIR_MAPPED_ORDER
+#define POCHOIR_MAPPED_ORDER
+#endif
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 3
+#define TOLERANCE (1e-6)
+
+int check_result(int t, int i, int j, int k, double a, double b)
+{
+	if (abs(a - b) < TOLERANCE) {
+//		printf("a(%d, %d, %d, %d) == b(%d, %d, %d, %d) == %f : passed!\n", t, i, j, k, t, i, j, k, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d, %d) = %f, b(%d, %d, %d, %d) = %f : FAILED!\n", t, i, j, k, a, t, i, j, k, b);
+        return 1;
+	}
+
+}
+
+int main(int argc, char * argv[])
+{
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    double min_tdiff = INF;
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+    Pochoir_Shape_3D heat_shape_3D[] = {{0, 0, 0, 0}, {-1, 1, 0, 0}, {-1, -1, 0, 0}, {-1, 0, 0, 0}, {-1, 0, 0, -1}, {-1, 0, 0, 1}, {-1, 0, 1, 0}, {-1, 0, -1, 0}};
+    Pochoir_3D heat_3D(heat_shape_3D), tiled_heat_3D(heat_shape_3D), morton_heat_3D(heat_shape_3D);
+	Pochoir_Boundary_Array_3D(double, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE, N_SIZE), b(N_SIZE, N_SIZE, N_SIZE), c(N_SIZE, N_SIZE, N_SIZE);
+    heat_3D.Register_Array(a);
+
+    b.Register_Tiling();
+    tiled_heat_3D.Register_Array(b);
+
+    c.Register_Morton();
+    morton_heat_3D.Register_Array(c);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+    for (int k = 0; k < N_SIZE; ++k) {
+        a(0, i, j, k) = 1.0 * (rand() % BASE); 
+        a(1, i, j, k) = 0; 
+        b(0, i, j, k) = c(0, i, j, k) = a(0, i, j, k);
+        b(1, i, j, k) = c(1, i, j, k) = 0;
+	} } }
+
+    Pochoir_Kernel_3D(heat_3D_fn, t, i, j, k)
+	   a(t, i, j, k) = 
+           0.125 * (a(t-1, i+1, j, k) - 2.0 * a(t-1, i, j, k) + a(t-1, i-1, j, k)) 
+         + 0.125 * (a(t-1, i, j+1, k) - 2.0 * a(t-1, i, j, k) + a(t-1, i, j-1, k)) 
+         + 0.125 * (a(t-1, i, j, k+1) - 2.0 * a(t-1, i, j, k) + a(t-1, i, j, k-1))
+         + a(t-1, i, j, k);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_3D(tiled_heat_3D_fn, t, i, j, k)
+	   b(t, i, j, k) = 
+           0.125 * (b(t-1, i+1, j, k) - 2.0 * b(t-1, i, j, k) + b(t-1, i-1, j, k)) 
+         + 0.125 * (b(t-1, i, j+1, k) - 2.0 * b(t-1, i, j, k) + b(t-1, i, j-1, k)) 
+         + 0.125 * (b(t-1, i, j, k+1) - 2.0 * b(t-1, i, j, k) + b(t-1, i, j, k-1))
+         + b(t-1, i, j, k);
+    Pochoir_Kernel_End
+
+    Pochoir_Kernel_3D(morton_heat_3D_fn, t, i, j, k)
+	   c(t, i, j, k) = 
+           0.125 * (c(t-1, i+1, j, k) - 2.0 * c(t-1, i, j, k) + c(t-1, i-1, j, k)) 
+         + 0.125 * (c(t-1, i, j+1, k) - 2.0 * c(t-1, i, j, k) + c(t-1, i, j-1, k)) 
+         + 0.125 * (c(t-1, i, j, k+1) - 2.0 * c(t-1, i, j, k) + c(t-1, i, j, k-1))
+         + c(t-1, i, j, k);
+    Pochoir_Kernel_End
+
+    for (int times = 0; times < TIMES; ++times) {
+	    gettimeofday(&start, 0);
+        heat_3D.Run(T_SIZE, heat_3D_fn);
+	    gettimeofday(&end, 0);
+        min_tdiff = min(min_tdiff, (1.0e3 * tdiff(&end, &start)));
+    }
+	std::cout << "Pochoir (row-major) : consumed time :" << min_tdiff << "ms" << std::endl;
+
+    min_tdiff = INF;
+    for (int times = 0; times < TIMES; ++times) {
+	    gettimeofday(&start, 0);
+        tiled_heat_3D.Run(T_SIZE, tiled_heat_3D_fn);
+	    gettimeofday(&end, 0);
+        min_tdiff = min(min_tdiff, (1.0e3 * tdiff(&end, &start)));
+    }
+	std::cout << "Pochoir (tiled) : consumed time :" << min_tdiff << "ms" << std::endl;
+
+    min_tdiff = INF;
+    for (int times = 0; times < TIMES; ++times) {
+	    gettimeofday(&start, 0);
+        morton_heat_3D.Run(T_SIZE, morton_heat_3D_fn);
+	    gettimeofday(&end, 0);
+        min_tdiff = min(min_tdiff, (1.0e3 * tdiff(&end, &start)));
+    }
+	std::cout << "Pochoir (Morton) : consumed time :" << min_tdiff << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+    for (int k = 0; k < N_SIZE; ++k) {
+		failed += check_result(t, i, j, k, a.interior(t, i, j, k), b.interior(t, i, j, k));
+		failed += check_result(t, i, j, k, a.interior(t, i, j, k), c.interior(t, i, j, k));
+	} } }
+    printf("compare a with b and c : %s\n", failed ? "FAILED!" : "passed!");
+
+	return failed != 0;
+}
@@ -0,0 +1,152 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 3D heat equation, Periodic version, reduced-precision
+ * storage : arrays stored as float for a double solver, and as
+ * pochoir_half or pochoir_bfloat16 for a float one, against the array of
+ * double, each within the precision of its storage type
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+#define N_RANK 3
+
+int check_result(int t, int i, int j, int k, double a, double b, double tolerance)
+{
+	if (abs(a - b) <= tolerance) {
+//		printf("a(%d, %d, %d, %d) == b(%d, %d, %d, %d) == %f : passed!\n", t, i, j, k, t, i, j, k, a);
+        return 0;
+	} else {
+		printf("a(%d, %d, %d, %d) = %f, b(%d, %d, %d, %d) = %f : FAILED!\n", t, i, j, k, a, t, i, j, k, b);
+        return 1;
+	}
+
+}
+
+/* runs the heat equation on a of double and on b of T_Elem from the same
+ * initial values, returns the # of points that differ by more than T_SIZE
+ * units in the last place _ulp of the storage type of b at T_SIZE : the
+ * values stay in [0, 1), each time step rounds them to the storage type
+ * once, and the kernel is a weighted average, which does not grow the
+ * error of the previous steps
+ */
+template <typename T_Elem>
+int run_heat(char const * _name, int N_SIZE, int T_SIZE, double _ulp)
+{
+    const double l_tolerance = T_SIZE * _ulp;
+	const int BASE = 1024;
+	int t;
+	struct timeval start, end;
+    double min_tdiff = INF;
+    Pochoir_Shape_3D heat_shape_3D[] = {{0, 0, 0, 0}, {-1, 1, 0, 0}, {-1, -1, 0, 0}, {-1, 0, 0, 0}, {-1, 0, 0, -1}, {-1, 0, 0, 1}, {-1, 0, 1, 0}, {-1, 0, -1, 0}};
+    Pochoir_3D heat_3D(heat_shape_3D), stored_heat_3D(heat_shape_3D);
+	Pochoir_Boundary_Array_3D(double, Pochoir_Boundary_Periodic) a(N_SIZE, N_SIZE, N_SIZE);
+    Pochoir_Boundary_Array_3D(T_Elem, Pochoir_Boundary_Periodic) b(N_SIZE, N_SIZE, N_SIZE);
+    heat_3D.Register_Array(a);
+    stored_heat_3D.Register_Array(b);
+
+    /* the initial values are exact in all the storage types */
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+    for (int k = 0; k < N_SIZE; ++k) {
+        a(0, i, j, k) = 1.0 * (rand() % BASE) / BASE; 
+        a(1, i, j, k) = 0; 
+        b(0, i, j, k) = a(0, i, j, k);
+        b(1, i, j, k) = 0;
+	} } }
+
+    printf("%s :\n", _name);
+    Pochoir_Kernel_3D(heat_3D_fn, t, i, j, k)
+	   a(t, i, j, k) = 
+           0.125 * (a(t-1, i+1, j, k) - 2.0 * a(t-1, i, j, k) + a(t-1, i-1, j, k)) 
+         + 0.125 * (a(t-1, i, j+1, k) - 2.0 * a(t-1, i, j, k) + a(t-1, i, j-1, k)) 
+         + 0.125 * (a(t-1, i, j, k+1) - 2.0 * a(t-1, i, j, k) + a(t-1, i, j, k-1))
+         + a(t-1, i, j, k);
+    Pochoir_Kernel_End
+
+    /* written as for an array of the compute type */
+    Pochoir_Kernel_3D(stored_heat_3D_fn, t, i, j, k)
+	   b(t, i, j, k) = 
+           0.125 * (b(t-1, i+1, j, k) - 2.0 * b(t-1, i, j, k) + b(t-1, i-1, j, k)) 
+         + 0.125 * (b(t-1, i, j+1, k) - 2.0 * b(t-1, i, j, k) + b(t-1, i, j-1, k)) 
+         + 0.125 * (b(t-1, i, j, k+1) - 2.0 * b(t-1, i, j, k) + b(t-1, i, j, k-1))
+         + b(t-1, i, j, k);
+    Pochoir_Kernel_End
+
+    for (int times = 0; times < TIMES; ++times) {
+	    gettimeofday(&start, 0);
+        heat_3D.Run(T_SIZE, heat_3D_fn);
+	    gettimeofday(&end, 0);
+        min_tdiff = min(min_tdiff, (1.0e3 * tdiff(&end, &start)));
+    }
+	std::cout << "Pochoir (double) : consumed time :" << min_tdiff << "ms" << std::endl;
+
+    min_tdiff = INF;
+    for (int times = 0; times < TIMES; ++times) {
+	    gettimeofday(&start, 0);
+        stored_heat_3D.Run(T_SIZE, stored_heat_3D_fn);
+	    gettimeofday(&end, 0);
+        min_tdiff = min(min_tdiff, (1.0e3 * tdiff(&end, &start)));
+    }
+	std::cout << "Pochoir (" << _name << ") : consumed time :" << min_tdiff << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < N_SIZE; ++j) {
+    for (int k = 0; k < N_SIZE; ++k) {
+		failed += check_result(t, i, j, k, a.interior(t, i, j, k), b.interior(t, i, j, k), l_tolerance);
+	} } }
+    printf("compare a with b : %s\n", failed ? "FAILED!" : "passed!");
+    return failed;
+}
+
+int main(int argc, char * argv[])
+{
+    int N_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    printf("N_SIZE = %d, T_SIZE = %d\n", N_SIZE, T_SIZE);
+
+    /* ulp of [0.5, 1) : 24 bits of float, 11 of half, 8 of bfloat16 */
+    int failed = run_heat<float>("float", N_SIZE, T_SIZE, ldexp(1.0, -24));
+    failed += run_heat<Pochoir_Stored<double, float> >("double stored as float", N_SIZE, T_SIZE, ldexp(1.0, -24));
+    failed += run_heat<Pochoir_Stored<float, pochoir_half> >("float stored as half", N_SIZE, T_SIZE, ldexp(1.0, -11));
+    failed += run_heat<Pochoir_Stored<float, pochoir_bfloat16> >("float stored as bfloat16", N_SIZE, T_SIZE, ldexp(1.0, -8));
+
+	return failed != 0;
+}
@@ -0,0 +1,141 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ * 	 
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+/* Test bench - 2D Game of Life on bit-packed arrays, Periodic and zero
+ * boundaries : the word-parallel Pochoir_Bit_Life_Kernel on a
+ * pochoir_bit array against the cell kernel on a bool array
+ */
+#include <cstdio>
+#include <cstddef>
+#include <iostream>
+#include <cstdlib>
+#include <sys/time.h>
+#include <cmath>
+
+#include <pochoir.hpp>
+
+using namespace std;
+#define TIMES 1
+
+int check_result(int t, int j, int i, bool a, bool b)
+{
+	if (a == b) {
+//		printf("a(%d, %d, %d) == b(%d, %d, %d) == %s : passed!\n", t, j, i, t, j, i, a ? "True" : "False");
+        return 0;
+	} else {
+		printf("a(%d, %d, %d) = %s, b(%d, %d, %d) = %s : FAILED!\n", t, j, i, a ? "True" : "False", t, j, i, b ? "True" : "False");
+        return 1;
+	}
+
+}
+
+/* N_SIZE x M_SIZE cells, with the periodic or zero (dead) boundary
+ * T_Boundary, returns the # of cells that differ at T_SIZE
+ */
+template <typename T_Boundary>
+int run_life(char const * _name, int N_SIZE, int M_SIZE, int T_SIZE)
+{
+	int t;
+	struct timeval start, end;
+    Pochoir_Shape_2D life_shape_2D[] = {{0, 0, 0}, {-1, 1, 0}, {-1, -1, 0}, {-1, 0, 1}, {-1, 0, -1}, {-1, 1, 1}, {-1, -1, -1}, {-1, 1, -1}, {-1, -1, 1}, {-1, 0, 0}};
+    Pochoir_2D life_2D(life_shape_2D), bit_life_2D(life_shape_2D);
+	Pochoir_Boundary_Array_2D(bool, T_Boundary) a(N_SIZE, M_SIZE);
+    Pochoir_Boundary_Array_2D(pochoir_bit, T_Boundary) d(N_SIZE, M_SIZE);
+
+    life_2D.Register_Array(a);
+    bit_life_2D.Register_Array(d);
+
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < M_SIZE; ++j) {
+		a(0, i, j) = (rand() & 0x1) ? true : false;
+		a(1, i, j) = 0; 
+        d(0, i, j) = a(0, i, j);
+        d(1, i, j) = 0;
+	} }
+
+    printf("Game of Life (%s) : %d x %d, %d time steps\n", _name, N_SIZE, M_SIZE, T_SIZE);
+
+    Pochoir_Kernel_2D(life_2D_fn, t, i, j)
+    int neighbors = a(t-1, i-1, j-1) + a(t-1, i-1, j) + a(t-1, i-1, j+1) +
+                    a(t-1, i, j-1)                  + a(t-1, i, j+1) +
+                    a(t-1, i+1, j-1) + a(t-1, i+1, j) + a(t-1, i+1, j+1);
+    if (a(t-1, i, j) == true && neighbors < 2)
+        a(t, i, j) = false;
+    else if (a(t-1, i, j) == true && neighbors > 3) { 
+        a(t, i, j) = false;
+    } else if (a(t-1, i, j) == false && neighbors == 3) 
+        a(t, i, j) = true;
+    else
+        a(t, i, j) = a(t-1, i, j);
+    Pochoir_Kernel_End
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        life_2D.Run(T_SIZE, life_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (bool) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+    /* B3/S23, 64 cells a word in the interior zoids, 
+     * cell by cell in the boundary zoids
+     */
+    Pochoir_Bit_Life_Kernel<Pochoir_Boundary_Array_2D(pochoir_bit, T_Boundary)> bit_life_2D_fn(d);
+
+	gettimeofday(&start, 0);
+    for (int times = 0; times < TIMES; ++times) {
+        bit_life_2D.Run_Obase(T_SIZE, bit_life_2D_fn, bit_life_2D_fn);
+    }
+	gettimeofday(&end, 0);
+	std::cout << "Pochoir (bit-packed) : consumed time :" << 1.0e3 * tdiff(&end, &start)/TIMES << "ms" << std::endl;
+
+	t = T_SIZE;
+    int failed = 0;
+    printf("compare a with d : ");
+	for (int i = 0; i < N_SIZE; ++i) {
+	for (int j = 0; j < M_SIZE; ++j) {
+		failed += check_result(t, i, j, a.interior(t, i, j), d.interior(t, i, j));
+	} } 
+    printf(failed ? "FAILED!\n" : "passed!\n");
+    return failed;
+}
+
+int main(int argc, char * argv[])
+{
+    int N_SIZE = 0, M_SIZE = 0, T_SIZE = 0;
+
+    if (argc < 3) {
+        printf("argc < 3, quit! \n");
+        exit(1);
+    }
+    N_SIZE = StrToInt(argv[1]);
+    T_SIZE = StrToInt(argv[2]);
+    /* the rows need not fill whole words, e.g. 1000 x 1030 */
+    M_SIZE = (argc > 3) ? StrToInt(argv[3]) : N_SIZE;
+    printf("N_SIZE = %d, M_SIZE = %d, T_SIZE = %d\n", N_SIZE, M_SIZE, T_SIZE);
+
+    int failed = run_life<Pochoir_Boundary_Periodic>("periodic", N_SIZE, M_SIZE, T_SIZE);
+    failed += run_life<Pochoir_Boundary_Zero>("zero", N_SIZE, M_SIZE, T_SIZE);
+
+	return failed != 0;
+}
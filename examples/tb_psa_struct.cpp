@@ -357,17 +357,17 @@ int read_command_line( int argc, char *argv[ ], int &go_cost, int &ge_cost, int
 int stencilPSA4Arrays( int nX, char *X, int nY, char *Y, int goCost, int geCost, int *mmCost )
 {
     Pochoir_Shape< N_RANK > pSeq_shape_G[ ] = { { 1, 0 }, { 0, 0 }, { 0, -1 } };    
-    Pochoir_Shape< N_RANK > pSeq_shape_G2[ ] = { { 1, 0 }, { 0, 0 } };    
+    Pochoir_Shape< N_RANK > pSeq_shape_G2[ ] = { { 1, 0 }, { 0, -1 } };    
     Pochoir_Shape< N_RANK > pSeq_shape_D[ ] = { { 1, 0 }, { 0, 0 } };    
     Pochoir_Shape< N_RANK > pSeq_shape_I[ ] = { { 1, 0 }, { 0, -1 } };    
     Pochoir< N_RANK > pSeq(pSeq_shape_G);
     Pochoir_Array< int, N_RANK > vG( nY + 1 ), vG2( nY + 1 ), vD( nY + 1 ), vI( nY + 1 );
     Pochoir_Domain J( 0, nY + 1 );
                 
-    pSeq.Register_Array( vG );
-    pSeq.Register_Array( vG2 );
-    pSeq.Register_Array( vD );
-    pSeq.Register_Array( vI );            
+    pSeq.Register_Array( vG, pSeq_shape_G );
+    pSeq.Register_Array( vG2, pSeq_shape_G2 );
+    pSeq.Register_Array( vD, pSeq_shape_D );
+    pSeq.Register_Array( vI, pSeq_shape_I );            
     pSeq.Register_Domain( J );
     
     vG( 0, 0 ) = vG2( 0, 0 ) = 0;
@@ -685,6 +685,26 @@ int main( int argc, char *argv[ ] )
         printf( "\t alignment cost = %d\n", optCost2 );    
         if ( t0 > 0 ) printf( "\t Running time = %.3lf sec ( %.3lf x Pochoir-Struct )\n\n", t1, t1 / t0 );    
         else printf( "\t Running time = %.3lf sec\n\n", t1 );    
+
+        printf( "Running pochoir-based DP ( four arrays, each with its own shape )..." );
+        fflush( stdout );
+                      
+        gettimeofday( &start, 0 );        
+        int optCost4 = stencilPSA4Arrays( nX, X, nY, Y, goCost, geCost, mmCost );    
+        gettimeofday( &end, 0 );
+
+        double t4 = tdiff( &end, &start );
+      
+        printf( "\n\nPochoir ( four arrays ):\n" );
+        printf( "\t alignment cost = %d\n", optCost4 );    
+        if ( t0 > 0 ) printf( "\t Running time = %.3lf sec ( %.3lf x Pochoir-Struct )\n\n", t4, t4 / t0 );    
+        else printf( "\t Running time = %.3lf sec\n\n", t4 );    
+
+        if ( optCost4 != optCost || optCost4 != optCost2 )
+          {
+            printf( "Error: alignment costs differ ( %d, %d, %d )!\n\n", optCost, optCost2, optCost4 );
+            return 1;
+          }
       
         if ( RunIterativeStencil )
           {
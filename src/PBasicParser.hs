@@ -133,14 +133,20 @@ ppArray l_id l_state =
 ppStencil :: String -> ParserState -> GenParser Char ParserState String
 ppStencil l_id l_state = 
         do try $ pMember "Register_Array"
-           l_array <- parens identifier
+           l_arrayParams <- parens $ commaSep1 identifier
            semi
+           let l_array = head l_arrayParams
+           -- Register_Array(array, shape) gives the array its own toggle
+           let l_shapeToggle = case tail l_arrayParams of
+                                   [] -> 0
+                                   (l_shape:_) -> shapeToggle $ getPShape l_state l_shape
            case Map.lookup l_id $ pStencil l_state of 
-               Nothing -> return (l_id ++ ".Register_Array(" ++ l_array ++ "); /* UNKNOWN Register_Array with" ++ l_id ++ "*/" ++ breakline)
+               Nothing -> return (l_id ++ ".Register_Array(" ++ intercalate ", " l_arrayParams ++ "); /* UNKNOWN Register_Array with" ++ l_id ++ "*/" ++ breakline)
                Just l_stencil -> 
-                   case Map.lookup l_array $ pArray l_state of
-                       Nothing -> registerUndefinedArray l_id l_array l_stencil 
-                       Just l_pArray -> registerArray l_id l_array l_pArray l_stencil
+                   let l_toggle = if l_shapeToggle > 0 then l_shapeToggle else sToggle l_stencil
+                   in  case Map.lookup l_array $ pArray l_state of
+                           Nothing -> registerUndefinedArray l_id l_arrayParams l_stencil 
+                           Just l_pArray -> registerArray l_id l_arrayParams l_pArray l_toggle
     <|> do try $ pMember "Register_Boundary"
            l_boundaryParams <- parens $ commaSep1 identifier
            semi
@@ -152,11 +158,11 @@ ppStencil l_id l_state =
                    case Map.lookup l_array $ pArray l_state of
                        Nothing -> registerUndefinedBoundaryFn l_id l_boundaryParams l_stencil
                        Just l_pArray -> registerBoundaryFn l_id l_boundaryParams l_pArray
-    <|> do try $ pMember "Run"
-           (l_tstep, l_func) <- parens pStencilRun
+    <|> do l_method <- try (pMember "Run") <|> try (pMember "Advance")
+           (l_tstep, l_func, l_policy) <- parens pStencilRun
            semi
            case Map.lookup l_id $ pStencil l_state of
-               Nothing -> return (l_id ++ ".Run(" ++ show l_tstep ++ ", " ++ l_func ++ "); /*Run with  UNKNOWN Stencil " ++ l_id ++ "*/" ++ breakline)
+               Nothing -> return (l_id ++ "." ++ l_method ++ "(" ++ show l_tstep ++ ", " ++ l_func ++ pShowPolicyArg l_policy ++ "); /*" ++ l_method ++ " with  UNKNOWN Stencil " ++ l_id ++ "*/" ++ breakline)
                Just l_stencil -> 
                    do let l_arrayInUse = sArrayInUse l_stencil
                       let l_regBound = foldr (||) False $ map (getArrayRegBound l_state) l_arrayInUse 
@@ -164,7 +170,7 @@ ppStencil l_id l_state =
                       l_newState <- getState
                       let l_newStencil = getPStencil l_id l_newState l_stencil
                       case Map.lookup l_func $ pKernel l_newState of
-                          Nothing -> return ("{" ++ breakline ++ l_id ++ ".Run(" ++ l_tstep ++ ", " ++ l_func ++ ");" ++ breakline ++ "} /* Didn't find the kernel_func */ " ++ breakline)
+                          Nothing -> return ("{" ++ breakline ++ l_id ++ "." ++ l_method ++ "(" ++ l_tstep ++ ", " ++ l_func ++ pShowPolicyArg l_policy ++ ");" ++ breakline ++ "} /* Didn't find the kernel_func */ " ++ breakline)
                           Just l_kernel -> 
                               let l_revKernel = transKernel l_kernel l_newStencil $ pMode l_newState
                               in  
@@ -174,28 +180,28 @@ ppStencil l_id l_state =
                                               if sRank l_newStencil < 3
                                                  then pShowOptPointerKernel
                                                  else pShowPointerKernel
-                                        in  pSplitObase 
-                                             ("Default_", l_id, l_tstep, l_revKernel, 
+                                        in  pSplitObase l_method
+                                             ("Default_", l_id, l_tstep, l_policy, l_revKernel, 
                                                l_newStencil) 
                                              l_showKernel
                                     PMacroShadow -> 
-                                        pSplitScope 
-                                          ("macro_", l_id, l_tstep, l_revKernel, 
+                                        pSplitScope l_method
+                                          ("macro_", l_id, l_tstep, l_policy, l_revKernel, 
                                             l_newStencil) 
                                           (pShowMacroKernel ".interior" $ sArrayInUse l_newStencil)
                                     PPointer -> 
-                                         pSplitObase 
-                                          ("Pointer_", l_id, l_tstep, l_revKernel, 
+                                         pSplitObase l_method
+                                          ("Pointer_", l_id, l_tstep, l_policy, l_revKernel, 
                                             l_newStencil) 
                                           pShowPointerKernel
                                     POptPointer -> 
-                                         pSplitObase 
-                                          ("Opt_Pointer_", l_id, l_tstep, l_revKernel, 
+                                         pSplitObase l_method
+                                          ("Opt_Pointer_", l_id, l_tstep, l_policy, l_revKernel, 
                                             l_newStencil) 
                                           pShowOptPointerKernel
                                     PCPointer -> 
-                                         pSplitObase 
-                                          ("C_Pointer_", l_id, l_tstep, l_revKernel, 
+                                         pSplitObase l_method
+                                          ("C_Pointer_", l_id, l_tstep, l_policy, l_revKernel, 
                                             l_newStencil) 
                                           pShowCPointerKernel
     <|> do return (l_id)
@@ -230,21 +236,22 @@ transKernel l_kernel l_stencil l_mode =
            l_revIters = transIterN 0 l_iters
        in  l_kernel { kIter = l_revIters }
  
-pSplitScope :: (String, String, String, PKernel, PStencil) -> (String -> PKernel -> String) -> GenParser Char ParserState String
-pSplitScope (l_tag, l_id, l_tstep, l_kernel, l_stencil) l_showKernel = 
+-- l_method is "Run" or "Advance", the latter continues from the current time
+pSplitScope :: String -> (String, String, String, String, PKernel, PStencil) -> (String -> PKernel -> String) -> GenParser Char ParserState String
+pSplitScope l_method (l_tag, l_id, l_tstep, l_policy, l_kernel, l_stencil) l_showKernel = 
     let oldKernelName = kName l_kernel
         bdryKernelName = "bdry_" ++ oldKernelName
         obaseKernelName = l_tag ++ oldKernelName
         bdryKernel = pShowMacroKernel ".boundary" (sArrayInUse l_stencil) 
                                                   bdryKernelName l_kernel
         obaseKernel = l_showKernel obaseKernelName l_kernel
-        runKernel = obaseKernelName ++ ", " ++ bdryKernelName
+        runKernel = obaseKernelName ++ ", " ++ bdryKernelName ++ pShowPolicyArg l_policy
     in  return ("{" ++ breakline ++ bdryKernel ++ breakline ++ obaseKernel ++ breakline ++ 
-                l_id ++ ".Run(" ++ l_tstep ++ ", " ++ runKernel ++ ");" ++ breakline ++ 
+                l_id ++ "." ++ l_method ++ "(" ++ l_tstep ++ ", " ++ runKernel ++ ");" ++ breakline ++ 
                 "}" ++ breakline)
 
-pSplitObase :: (String, String, String, PKernel, PStencil) -> (String -> PKernel -> String) -> GenParser Char ParserState String
-pSplitObase (l_tag, l_id, l_tstep, l_kernel, l_stencil) l_showKernel = 
+pSplitObase :: String -> (String, String, String, String, PKernel, PStencil) -> (String -> PKernel -> String) -> GenParser Char ParserState String
+pSplitObase l_method (l_tag, l_id, l_tstep, l_policy, l_kernel, l_stencil) l_showKernel = 
     let oldKernelName = kName l_kernel 
         bdryKernelName = "bdry_" ++ oldKernelName
         obaseKernelName = l_tag ++ oldKernelName 
@@ -253,24 +260,32 @@ pSplitObase (l_tag, l_id, l_tstep, l_kernel, l_stencil) l_showKernel =
                                                   bdryKernelName l_kernel
         obaseKernel = l_showKernel obaseKernelName l_kernel 
         runKernel = 
-            if regBound then obaseKernelName ++ ", " ++ bdryKernelName
+            (if regBound then obaseKernelName ++ ", " ++ bdryKernelName
             -- if the boundary function is NOT registered, we guess user are using 
             -- zero-padding. Note: there's no zero-padding for Periodic stencils
-                        else obaseKernelName
+                        else obaseKernelName) ++ pShowPolicyArg l_policy
     in  return ("{" ++ breakline ++ bdryKernel ++ breakline ++ obaseKernel ++ breakline ++ 
-                l_id ++ ".Run_Obase(" ++ l_tstep ++ ", " ++ runKernel ++ ");" ++ 
+                l_id ++ "." ++ l_method ++ "_Obase(" ++ l_tstep ++ ", " ++ runKernel ++ ");" ++ 
                 breakline ++ "}" ++ breakline)
 -------------------------------------------------------------------------------------------
 --                             Following are C++ Grammar Parser                         ---
 -------------------------------------------------------------------------------------------
-pStencilRun :: GenParser Char ParserState (String, String)
+-- Run/Advance(timestep, kernel [, policy]), the optional Pochoir_Policy is 
+-- passed on verbatim to the generated Run()/Run_Obase() or
+-- Advance()/Advance_Obase()
+pStencilRun :: GenParser Char ParserState (String, String, String)
 pStencilRun = 
         do l_tstep <- try exprStmtDim
            comma
            l_func <- identifier
-           return (show l_tstep, l_func)
+           l_policy <- option "" (comma >> identifier)
+           return (show l_tstep, l_func, l_policy)
     <?> "Stencil Run Parameters"
 
+pShowPolicyArg :: String -> String
+pShowPolicyArg "" = ""
+pShowPolicyArg l_policy = ", " ++ l_policy
+
 -- Register_Boundary :: String -> String -> PArray -> GenParser Char ParserState String
 -- Register_Boundary l_id l_boundaryFn l_array =
 --     do updateState $ updateArrayBoundary l_id True 
@@ -304,9 +319,10 @@ registerBoundaryFn l_id l_boundaryParams l_pArray =
        return (l_id ++ ".Register_Boundary(" ++ (intercalate ", " l_boundaryParams) ++ 
                "); /* register Boundary Fn */" ++ breakline)
 
-registerUndefinedArray :: String -> String -> PStencil -> GenParser Char ParserState String
-registerUndefinedArray l_id l_arrayName l_stencil =
-    let l_pArray = PArray {aName = l_arrayName,
+registerUndefinedArray :: String -> [String] -> PStencil -> GenParser Char ParserState String
+registerUndefinedArray l_id l_arrayParams l_stencil =
+    let l_arrayName = head l_arrayParams
+        l_pArray = PArray {aName = l_arrayName,
                            aType = PType { basicType = PUserType, typeName = "UnknownType" },
                            aRank = sRank l_stencil,
                            aDims = [],
@@ -315,15 +331,15 @@ registerUndefinedArray l_id l_arrayName l_stencil =
                            aRegBound = False}
     in  do -- updateState $ updatePArray [(l_arrayName, l_pArray)]
            -- updateState $ updateStencilArray l_id l_pArray 
-           return (l_id ++ ".Register_Array (" ++ l_arrayName ++ 
+           return (l_id ++ ".Register_Array (" ++ intercalate ", " l_arrayParams ++ 
                    "); /* register Undefined Array */" ++ breakline)
     
-registerArray :: String -> String -> PArray -> PStencil -> GenParser Char ParserState String
-registerArray l_id l_arrayName l_pArray l_stencil =
-    -- assume all participating array has the same shape/toggle! Is that true?
-    let l_revArray = l_pArray { aToggle = sToggle l_stencil }
+-- l_toggle is the toggle of the array's own shape, or of the stencil's shape
+registerArray :: String -> [String] -> PArray -> Int -> GenParser Char ParserState String
+registerArray l_id l_arrayParams l_pArray l_toggle =
+    let l_revArray = l_pArray { aToggle = l_toggle }
     in  do updateState $ updateStencilArray l_id l_revArray
-           return (l_id ++ ".Register_Array (" ++ l_arrayName ++ 
+           return (l_id ++ ".Register_Array (" ++ intercalate ", " l_arrayParams ++ 
                    "); /* register Array */" ++ breakline)
 
 -- pDeclStatic <type, rank>
@@ -334,6 +350,17 @@ pDeclStatic = do l_type <- pType
                  l_rank <- exprDeclDim
                  return (l_type, l_rank)
 
+-- pDeclStaticIndex <type, rank[, index type[, boundary]]> : the index
+-- type (see Pochoir_Array::index_type) and the boundary policy (see
+-- Pochoir_Array::boundary_policy) of the array are kept as the text
+-- re-emitted after the rank
+pDeclStaticIndex :: GenParser Char ParserState (PType, PValue, String)
+pDeclStaticIndex = do (l_type, l_rank) <- pDeclStatic
+                      l_args <- many (do comma
+                                         l_atype <- pType
+                                         return (", " ++ show l_atype))
+                      return (l_type, l_rank, concat l_args)
+
 pDeclStaticNum :: GenParser Char ParserState (PValue)
 pDeclStaticNum = do l_rank <- exprDeclDim
                     return (l_rank)
@@ -601,12 +628,19 @@ pType = do reserved "double"
     <|> do reserved "void"
            return PType{typeName = "void", basicType = PVoid}
     <|> do l_type <- identifier
+           l_args <- option "" (try pTemplateArgs)
            l_qualifiers <- many cppQualifier
-           return PType{typeName = l_type ++ (intercalate " " l_qualifiers), basicType = PUserType}
+           return PType{typeName = l_type ++ l_args ++ (intercalate " " l_qualifiers), basicType = PUserType}
     <|> do l_qualifiers <- many cppQualifier
            l_type <- identifier 
            return PType{typeName = (intercalate " " l_qualifiers) ++ l_type, basicType = PUserType}
 
+-- the arguments of a class template, e.g. the element type
+-- Pochoir_Stored<float, pochoir_half> of a Pochoir_Stored_Array_ND
+pTemplateArgs :: GenParser Char ParserState String
+pTemplateArgs = do l_args <- angles (commaSep1 pType)
+                   return ("<" ++ intercalate ", " (map show l_args) ++ ">")
+
 eol :: GenParser Char ParserState String
 eol = do string "\n" 
          whiteSpace
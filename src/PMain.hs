@@ -175,7 +175,7 @@ gcc = "g++"
 
 gccPPFlags = ["-E","-DNCHECK_SHAPE", "-DNDEBUG"]
 
-gccFlags = ["-fcilkplus", "-O3", "-std=c++11", "-Wall", "-Wno-unknown-pragmas", "-Wno-strict-aliasing","-lcilkrts", "-lm"]
+gccFlags = ["-pthread", "-O3", "-std=c++11", "-Wall", "-Wno-unknown-pragmas", "-Wno-strict-aliasing", "-lm"]
 
 pochoirLibConfigPath = "/home/marcos/Work/PochoirInstall/src/"
 
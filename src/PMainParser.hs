@@ -77,23 +77,23 @@ pParseMacro =
 pParsePochoirArray :: GenParser Char ParserState String
 pParsePochoirArray =
     do reserved "Pochoir_Array"
-       (l_type, l_rank) <- angles $ try pDeclStatic
+       (l_type, l_rank, l_index) <- angles $ try pDeclStaticIndex
        l_arrayDecl <- commaSep1 pDeclDynamic
        l_delim <- pDelim 
        updateState $ updatePArray $ transPArray (l_type, l_rank) l_arrayDecl
        return (breakline ++ "/* Known*/ Pochoir_Array <" ++ show l_type ++ 
-               ", " ++ show l_rank ++ "> " ++ 
+               ", " ++ show l_rank ++ l_index ++ "> " ++ 
                pShowDynamicDecl l_arrayDecl pShowArrayDim ++ l_delim)
 
 pParsePochoirArrayAsParam :: GenParser Char ParserState String
 pParsePochoirArrayAsParam =
     do reserved "Pochoir_Array"
-       (l_type, l_rank) <- angles $ try pDeclStatic
+       (l_type, l_rank, l_index) <- angles $ try pDeclStaticIndex
        l_arrayDecl <- pDeclDynamic
        l_delim <- pDelim 
        updateState $ updatePArray $ transPArray (l_type, l_rank) [l_arrayDecl]
        return (breakline ++ "/* Known*/ Pochoir_Array <" ++ show l_type ++ 
-               ", " ++ show l_rank ++ "> " ++ 
+               ", " ++ show l_rank ++ l_index ++ "> " ++ 
                pShowDynamicDecl [l_arrayDecl] pShowArrayDim ++ l_delim)
 
 pParsePochoirStencil :: GenParser Char ParserState String
@@ -141,7 +141,10 @@ transStmts l_stmts@(a:as) l_action = transStmt a : transStmts as l_action
           transExpr (PVAR q v dL) = l_action (PVAR q v dL)
           transExpr (BVAR v dim) = BVAR v dim
           transExpr (BExprVAR v e) = BExprVAR v $ transExpr e
-          transExpr (SVAR t e c f) = SVAR t (transExpr e) c f
+          -- l_action may rewrite a whole a(t, i).field, see transCPointer
+          transExpr (SVAR t e c f) = 
+              let l_svar = l_action (SVAR t e c f)
+              in  if l_svar == SVAR t e c f then SVAR t (transExpr e) c f else l_svar
           transExpr (PSVAR t e c f) = PSVAR t (transExpr e) c f
           transExpr (Uno uop e) = Uno uop $ transExpr e
           transExpr (PostUno uop e) = PostUno uop $ transExpr e
@@ -214,7 +217,7 @@ pShowKernelParams l_kernel_params = intercalate ", " l_kernel_params
 
 pShowArrayGaps :: Int -> [PArray] -> String
 pShowArrayGaps _ [] = ""
-pShowArrayGaps l_rank l_array = breakline ++ "int " ++ 
+pShowArrayGaps l_rank l_array = breakline ++ "long " ++ 
         intercalate ", " (map (getArrayGaps (l_rank-1)) l_array) ++ ";"
 
 pShowInteriorKernel :: String -> PKernel -> String
@@ -308,10 +311,11 @@ pShowCPointerKernel l_name l_kernel =
     in  breakline ++ "auto " ++ l_name ++ " = [&] (" ++
         "int t0, int t1, grid_info<" ++ show l_rank ++ "> const & grid) {" ++ 
         breakline ++ "grid_info<" ++ show l_rank ++ "> l_grid = grid;" ++
-        pShowArrayInfo l_array ++ 
+        pShowArrayBytesInfo l_array ++ 
         breakline ++ pShowStrides l_rank l_array ++ breakline ++
         pShowRefMacro (kParams l_kernel) l_array ++
         "for (int " ++ l_t ++ " = t0; " ++ l_t ++ " < t1; ++" ++ l_t ++ ") { " ++ 
+        pShowSlotSet l_t l_array ++
         breakline ++ pShowRawForHeader (tail $ kParams l_kernel) ++
         breakline ++ pShowCPointerStmt l_kernel ++ breakline ++ pShowObaseForTail l_rank ++
         pShowObaseTail l_rank ++ breakline ++ pShowRefUnMacro l_array ++ 
@@ -329,11 +333,20 @@ transCPointer l_iters (PVAR q v dL) =
     case pIterLookup (v, dL) l_iters of
         Nothing -> PVAR q v dL
         Just iterName -> VAR q $ pRef v dL
+-- a(t, i).field goes straight to the field, wherever the layout of the
+-- array puts it
+transCPointer l_iters (SVAR t (PVAR q v dL) "." f) =
+    case pIterLookup (v, dL) l_iters of
+        Nothing -> SVAR t (PVAR q v dL) "." f
+        Just iterName -> VAR q $ pFieldRef v f dL
 transCPointer l_iters e = e
 
 pRef :: PName -> [DimExpr] -> String
 pRef a dL = "ref_" ++ a ++ "(" ++ (intercalate ", " $ map show dL) ++ ")"
 
+pFieldRef :: PName -> PName -> [DimExpr] -> String
+pFieldRef a f dL = "fref_" ++ a ++ "(" ++ f ++ ", " ++ (intercalate ", " $ map show dL) ++ ")"
+
 pShowRawForHeader :: [PName] -> String
 pShowRawForHeader [] = ""
 pShowRawForHeader pL@(p:ps) = 
@@ -354,22 +367,57 @@ pShowRefUnMacro :: [PArray] -> String
 pShowRefUnMacro [] = ""
 pShowRefUnMacro (a:as) = 
     let l_name = aName a
-    in  "#undef ref_" ++ l_name ++ breakline ++ breakline
-
+    in  "#undef ref_" ++ l_name ++ breakline ++ "#undef fref_" ++ l_name ++ 
+        breakline ++ breakline ++ pShowRefUnMacro as
+
+-- ref_a(t', i, j) picks the slot pointer of time step t' relative to the
+-- current time step t, set once per time step by pShowSlotSet, so the
+-- spatial loops do not recompute the time offset of every access.
+-- fref_a(f, t', i, j) is the field f of that element, addressed through
+-- Pochoir_Layout<T> so that it also works for the structure-of-arrays
+-- layout (see Pochoir_SoA_Layout), where it touches a single plane.
+-- The spatial index goes through the map tables of a tiled or
+-- Morton-ordered array, and through the strides otherwise
 pShowRefMacro :: [PName] -> [PArray] -> String
 pShowRefMacro _ [] = ""
 pShowRefMacro l_kernelParams aL@(a:as) =
     let l_name = aName a
+        l_type = show $ aType a
+        l_layout = "Pochoir_Layout<" ++ l_type ++ " >"
         l_t = head l_kernelParams
-        l_dims = tail l_kernelParams
-        l_toggle = aToggle a
+        l_macroParams = map ("_" ++) l_kernelParams
+        l_dims = tail l_macroParams
         l_rank = aRank a
-    in  "#define ref_" ++ l_name ++ "(" ++ pShowKernelParams l_kernelParams ++
-        ") " ++ l_name ++ "_base[" ++ pGetTimeOffset l_toggle (DimVAR l_t) ++
-        " * l_" ++ l_name ++ "_total_size + " ++ 
-        (intercalate " + " $ zipWith pMul l_dims $ pStrideList l_name l_rank) ++ "]" ++
+        l_slot = "l_" ++ l_name ++ "_slot[((" ++ head l_macroParams ++ ") - " ++ l_t ++
+                 ") & " ++ show (pSlotMask $ aToggle a) ++ "]"
+        l_index = "(l_" ++ l_name ++ "_mapped ? " ++
+                  (intercalate " + " $ zipWith pLookup l_dims $ pMapList l_name l_rank) ++
+                  " : " ++
+                  (intercalate " + " $ zipWith pMul l_dims $ pStrideList l_name l_rank) ++ ")"
+        l_plane = "l_" ++ l_name ++ "_plane"
+    in  "#define ref_" ++ l_name ++ "(" ++ pShowKernelParams l_macroParams ++
+        ") " ++ l_name ++ ".at(" ++ l_slot ++ ", " ++ l_index ++ ", " ++ l_plane ++ ")" ++
+        breakline ++ breakline ++
+        "#define fref_" ++ l_name ++ "(" ++ pShowKernelParams ("_f" : l_macroParams) ++
+        ") (*(decltype(((" ++ l_type ++ " *) 0)->_f) *) (" ++ l_slot ++
+        " + (long)(" ++ l_index ++ ") * " ++ l_layout ++ "::word + " ++
+        l_layout ++ "::field(offsetof(" ++ l_type ++ ", _f), " ++ l_plane ++ ")))" ++
         breakline ++ breakline ++ pShowRefMacro l_kernelParams as
 
+-- l_a_slot[s] points to the time step (t + s) of array 'a', in bytes
+-- (see Pochoir_Layout::bytes(), an element of a bit-packed array is a bit)
+pShowSlotSet :: PName -> [PArray] -> String
+pShowSlotSet _ [] = ""
+pShowSlotSet l_t (a:as) =
+    let l_name = aName a
+        l_mask = pSlotMask $ aToggle a
+        l_slot = "l_" ++ l_name ++ "_slot"
+    in  breakline ++ "char * " ++ l_slot ++ "[" ++ show (l_mask + 1) ++ "];" ++
+        breakline ++ "for (int l_s = 0; l_s < " ++ show (l_mask + 1) ++ "; ++l_s) " ++
+        l_slot ++ "[l_s] = " ++ l_name ++ "_bytes + Pochoir_Layout<" ++
+        show (aType a) ++ " >::bytes((long)((" ++ l_t ++ " + l_s) & " ++
+        show l_mask ++ ") * l_" ++ l_name ++ "_total_size);" ++ pShowSlotSet l_t as
+
 pStrideList :: PName -> Int -> [String]
 pStrideList a 1 = ["l_stride_" ++ a ++ "_" ++ show 0]
 pStrideList a r = ["l_stride_" ++ a ++ "_" ++ show (r-1)] ++ (pStrideList a $ r-1)
@@ -377,6 +425,14 @@ pStrideList a r = ["l_stride_" ++ a ++ "_" ++ show (r-1)] ++ (pStrideList a $ r-
 pMul :: String -> String -> String
 pMul a b = "(" ++ a ++ ") * " ++ b
 
+-- the index tables of a tiled or Morton-ordered array, see Pochoir_Array::map()
+pMapList :: PName -> Int -> [String]
+pMapList a 1 = ["l_" ++ a ++ "_map_" ++ show 0]
+pMapList a r = ["l_" ++ a ++ "_map_" ++ show (r-1)] ++ (pMapList a $ r-1)
+
+pLookup :: String -> String -> String
+pLookup a m = m ++ "[" ++ a ++ "]"
+
 pShowArrayInfo :: [PArray] -> String
 pShowArrayInfo [] = ""
 pShowArrayInfo arrayInUse = foldr pShowArrayInfoItem "" arrayInUse
@@ -385,13 +441,33 @@ pShowArrayInfo arrayInUse = foldr pShowArrayInfoItem "" arrayInUse
                 l_name = aName l_arrayItem
             in  str ++ breakline ++ show l_type ++ " * " ++ l_name ++ "_base"  ++ 
                 " = " ++ l_name ++ ".data();" ++ breakline ++
-                "const int " ++ "l_" ++ l_name ++ "_total_size = " ++ l_name ++
+                "const auto " ++ "l_" ++ l_name ++ "_total_size = " ++ l_name ++
                 ".total_size();" ++ breakline
 
+-- the C pointer kernels address the arrays in bytes, see Pochoir_Array::bytes()
+pShowArrayBytesInfo :: [PArray] -> String
+pShowArrayBytesInfo [] = ""
+pShowArrayBytesInfo arrayInUse = foldr pShowArrayBytesInfoItem "" arrayInUse
+    where pShowArrayBytesInfoItem l_arrayItem str =
+            let l_name = aName l_arrayItem
+            in  str ++ breakline ++ "char * " ++ l_name ++ "_bytes = " ++ 
+                l_name ++ ".bytes();" ++ breakline ++
+                "const auto " ++ "l_" ++ l_name ++ "_total_size = " ++ l_name ++
+                ".total_size();" ++ breakline ++
+                "const long " ++ "l_" ++ l_name ++ "_plane = " ++ l_name ++
+                ".plane();" ++ breakline ++
+                "const bool " ++ "l_" ++ l_name ++ "_mapped = " ++ l_name ++
+                ".mapped();" ++ breakline ++
+                concatMap (pShowMap l_name) [0..aRank l_arrayItem - 1]
+          pShowMap l_name r = "auto const * l_" ++ l_name ++ "_map_" ++ show r ++
+                " = " ++ l_name ++ ".map(" ++ show r ++ ");" ++ breakline
+
 pShowStrides :: Int -> [PArray] -> String
 pShowStrides n [] = ""
-pShowStrides n aL@(a:as) = "const int " ++ getStrides n aL ++ ";\n"
-    where getStrides n aL@(a:as) = intercalate ", " $ concat $ map (getStride n) aL
+-- one declaration per array, the strides are of its index type
+-- (see Pochoir_Array::index_type)
+pShowStrides n aL@(a:as) = concatMap (getStrides n) aL
+    where getStrides n a = "const auto " ++ intercalate ", " (getStride n a) ++ ";\n"
           getStride 1 a = let r = 0 
                           in  ["l_stride_" ++ (aName a) ++ "_" ++ show r ++
                               " = " ++ (aName a) ++ ".stride(" ++ show r ++ ")"]
@@ -550,15 +626,17 @@ pShowPointerSet iL@(i:is) l_kernelParams = concat $ map pShowPointerSetTerm iL
             in  breakline ++ iterName ++ " = " ++ l_arrayBaseName ++ " + " ++ 
                 l_arrayTimeOffset ++ " + " ++ l_arraySpaceOffset ++ ";" 
 
+-- the runtime keeps the toggle time steps in a power of two of slots
+-- (see Pochoir_Array::slots()), so the slot is a mask instead of a modulo
 pGetTimeOffset :: Int -> DimExpr -> String
-pGetTimeOffset toggle tDim 
-    | toggle == 2 = "((" ++ show tDim ++ ")" ++ " & 0x1" ++ ")"
-    | toggle == 4 = "((" ++ show tDim ++ ")" ++ " & 0x11" ++ ")"
-    | otherwise = "((" ++ show tDim ++ ") % " ++ show toggle ++ ")"
+pGetTimeOffset toggle tDim = "((" ++ show tDim ++ ") & " ++ show (pSlotMask toggle) ++ ")"
+
+pSlotMask :: Int -> Int
+pSlotMask toggle = (head $ dropWhile (< toggle) $ iterate (* 2) 1) - 1
 
 pCombineDim :: DimExpr -> String -> String
 -- l_stride_pa_0 may NOT necessary be "1", 
--- plus that we have already set all strides to be of type "const int"
+-- plus that we have already set all strides to the index type of the array
 pCombineDim de stride = "(" ++ show de ++ ") * " ++ stride
 
 pGetArrayStrideList :: Int -> PName -> [String]
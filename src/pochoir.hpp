@@ -29,50 +29,112 @@
 #include "pochoir_common.hpp"
 #include "pochoir_walk_recursive.hpp"
 #include "pochoir_array.hpp"
+#include "pochoir_tune.hpp"
+#include "pochoir_reduce.hpp"
+#include "pochoir_halo.hpp"
+#include "pochoir_file.hpp"
 /* assuming there won't be more than 10 Pochoir_Array in one Pochoir object! */
 #define ARRAY_SIZE 10
 template <int N_RANK>
 class Pochoir {
     private:
-        int slope_[N_RANK];
+        /* reach of the dependencies per time step towards x0 (lslope_)
+         * and towards x1 (rslope_), slope_ is the larger of the two
+         */
+        int slope_[N_RANK], lslope_[N_RANK], rslope_[N_RANK];
         grid_info<N_RANK> logic_grid_;
         grid_info<N_RANK> phys_grid_;
         int time_shift_;
         int toggle_;
+        /* current time : # of time steps computed so far */
         int timestep_;
         bool regArrayFlag, regLogicDomainFlag, regPhysDomainFlag, regShapeFlag;
         void checkFlag(bool flag, char const * str);
         void checkFlags(void);
+        void checkPolicy(Pochoir_Policy const & policy);
+        Pochoir_Policy policy_;
+        std::string tuneKey(Pochoir_Policy const & policy, char kind);
+        Pochoir_Policy tunedPolicy(Pochoir_Policy const & policy, char kind);
+        template <typename R>
+        void tuneThres(int timestep, char kind, R const & run);
+        template <typename R, typename P, typename A>
+        int runUntil(int every, int max_steps, R & red, P const & pred, A const & advance);
+        /* recorded zoid decompositions, see Pochoir_Policy::cache_plan */
+        std::map<std::vector<int>, Pochoir_Plan<N_RANK> > plans_;
+        template <typename R>
+        Pochoir_Plan<N_RANK> const & getPlan(char kind, int t0, int t1, Algorithm<N_RANK> const & algor, Pochoir_Policy const & policy, R const & record);
+        template <typename F, typename BF>
+        void walkBoundary(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f, BF const & bf);
+        template <typename F>
+        void walkObase(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f);
+        template <typename F, typename BF>
+        void walkObase(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f, BF const & bf);
         template <typename T_Array>
         void getPhysDomainFromArray(T_Array & arr);
         template <typename T_Array>
         void cmpPhysDomainFromArray(T_Array & arr);
         template <size_t N_SIZE>
         void Register_Shape(Pochoir_Shape<N_RANK> (& shape)[N_SIZE]);
+        void addShape(Pochoir_Shape<N_RANK> const * shape, int shape_size);
+        template <typename T, typename I, typename B>
+        bool knownArray(Pochoir_Array<T, N_RANK, I, B> & arr) const;
+        template <typename T, typename I, typename B>
+        void addArray(Pochoir_Array<T, N_RANK, I, B> & arr);
         Pochoir_Shape<N_RANK> * shape_;
         int shape_size_;
         int num_arr_;
         int arr_type_size_;
+        /* distinct arrays registered so far, and the sum of their element
+         * sizes times their own toggle, which is the working set per grid
+         * point
+         */
+        void * arr_list_[ARRAY_SIZE];
+        int arr_bytes_;
+        int bytesPerPoint() const { return arr_bytes_; }
+        /* arrays with halos, see Pochoir_Array::Register_Halo(), and the
+         * widest halo of them in each dimension
+         */
+        Pochoir_Halo_Array<N_RANK> halo_arr_[ARRAY_SIZE];
+        int num_halo_;
+        int halo_[N_RANK];
+        void checkHalo(Pochoir_Policy const & policy);
+        /* file-backed arrays, see Pochoir_Array::Register_File() */
+        Pochoir_File_Array<N_RANK> file_arr_[ARRAY_SIZE];
+        int num_file_;
+        template <typename F, typename BF>
+        void advanceObase(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy, char kind);
 
     public:
     template <size_t N_SIZE>
     Pochoir(Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
         for (int i = 0; i < N_RANK; ++i) {
-            slope_[i] = 0;
+            slope_[i] = lslope_[i] = rslope_[i] = 0;
             logic_grid_.x0[i] = logic_grid_.x1[i] = logic_grid_.dx0[i] = logic_grid_.dx1[i] = 0;
             phys_grid_.x0[i] = phys_grid_.x1[i] = phys_grid_.dx0[i] = phys_grid_.dx1[i] = 0;
         }
         timestep_ = 0;
+        time_shift_ = toggle_ = 0;
         regArrayFlag = regLogicDomainFlag = regPhysDomainFlag = regShapeFlag = false;
         Register_Shape(shape);
         regShapeFlag = true;
         num_arr_ = 0;
         arr_type_size_ = 0;
+        arr_bytes_ = 0;
+        num_halo_ = 0;
+        for (int i = 0; i < N_RANK; ++i)
+            halo_[i] = 0;
+        num_file_ = 0;
     }
     /* currently, we just compute the slope[] out of the shape[] */
     /* We get the grid_info out of arrayInUse */
-    template <typename T>
-    void Register_Array(Pochoir_Array<T, N_RANK> & arr);
+    template <typename T, typename I, typename B>
+    void Register_Array(Pochoir_Array<T, N_RANK, I, B> & arr);
+    /* register an array with its own shape, the array keeps only as many
+     * time steps as this shape needs, while the slopes follow the union
+     * of all shapes
+     */
+    template <typename T, typename I, typename B, size_t N_SIZE>
+    void Register_Array(Pochoir_Array<T, N_RANK, I, B> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]);
 
     /* We should still keep the Register_Domain for zero-padding!!! */
     template <typename Domain>
@@ -98,18 +160,81 @@ class Pochoir {
         arr.Register_Boundary(_bv);
         Register_Array(arr);
     } 
+    /* the policy used by all Run()/Run_Obase() without an explicit one */
+    void Register_Policy(Pochoir_Policy const & policy) { policy_ = policy; }
+    Pochoir_Policy const & policy() const { return policy_; }
+    /* drop all plans recorded with Pochoir_Policy::cache_plan */
+    void Clear_Plan_Cache() { plans_.clear(); }
     /* Executable Spec */
     template <typename BF>
     void Run(int timestep, BF const & bf);
+    template <typename BF>
+    void Run(int timestep, BF const & bf, Pochoir_Policy const & policy);
     /* safe/unsafe Executable Spec */
     template <typename F, typename BF>
     void Run(int timestep, F const & f, BF const & bf);
+    template <typename F, typename BF>
+    void Run(int timestep, F const & f, BF const & bf, Pochoir_Policy const & policy);
     /* obase for zero-padded region */
     template <typename F>
     void Run_Obase(int timestep, F const & f);
+    template <typename F>
+    void Run_Obase(int timestep, F const & f, Pochoir_Policy const & policy);
     /* obase for interior and ExecSpec for boundary */
     template <typename F, typename BF>
     void Run_Obase(int timestep, F const & f, BF const & bf);
+    template <typename F, typename BF>
+    void Run_Obase(int timestep, F const & f, BF const & bf, Pochoir_Policy const & policy);
+    /* Run()/Run_Obase() start from time 0, Advance()/Advance_Obase() 
+     * continue from the current time Time() for 'steps' more time steps,
+     * on the data left in the arrays by the previous call. 
+     * A window of no time step does nothing.
+     */
+    int Time() const { return timestep_; }
+    void Set_Time(int t) { timestep_ = t; }
+    template <typename BF>
+    void Advance(int steps, BF const & bf);
+    template <typename BF>
+    void Advance(int steps, BF const & bf, Pochoir_Policy const & policy);
+    template <typename F, typename BF>
+    void Advance(int steps, F const & f, BF const & bf);
+    template <typename F, typename BF>
+    void Advance(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy);
+    template <typename F>
+    void Advance_Obase(int steps, F const & f);
+    template <typename F>
+    void Advance_Obase(int steps, F const & f, Pochoir_Policy const & policy);
+    template <typename F, typename BF>
+    void Advance_Obase(int steps, F const & f, BF const & bf);
+    template <typename F, typename BF>
+    void Advance_Obase(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy);
+    /* Start from time 0 like Run()/Run_Obase() and advance in windows of
+     * 'every' time steps (the last one may be shorter) until pred(value)
+     * holds for the reduction 'red' at the last time step of a window, or 
+     * max_steps time steps are done. 'red' is evaluated inside the base 
+     * cases, see pochoir_reduce.hpp. Returns the # of time steps done, 
+     * the arrays hold the state of that time step.
+     */
+    template <typename BF, typename R, typename P>
+    int Run_Until(int every, int max_steps, BF const & bf, R & red, P const & pred);
+    template <typename F, typename BF, typename R, typename P>
+    int Run_Until(int every, int max_steps, F const & f, BF const & bf, R & red, P const & pred);
+    template <typename F, typename R, typename P>
+    int Run_Until_Obase(int every, int max_steps, F const & f, R & red, P const & pred);
+    template <typename F, typename BF, typename R, typename P>
+    int Run_Until_Obase(int every, int max_steps, F const & f, BF const & bf, R & red, P const & pred);
+    /* Search dt_thres/dx_thres[] for the fastest Run()/Run_Obase() of 
+     * this stencil under the registered policy and record the winner 
+     * in the tuning file, later runs pick it up automatically. 
+     * Each candidate is executed for 'timestep' steps, so the contents
+     * of the registered arrays are overwritten!
+     */
+    template <typename F, typename BF>
+    void Tune(int timestep, F const & f, BF const & bf);
+    template <typename F>
+    void Tune_Obase(int timestep, F const & f);
+    template <typename F, typename BF>
+    void Tune_Obase(int timestep, F const & f, BF const & bf);
 };
 
 template <int N_RANK>
@@ -130,6 +255,23 @@ void Pochoir<N_RANK>::checkFlags(void) {
     return;
 }
 
+template <int N_RANK>
+void Pochoir<N_RANK>::checkPolicy(Pochoir_Policy const & policy) {
+    if (policy.topology == POCHOIR_TOPOLOGY_KLEIN && N_RANK != 2) {
+        printf("\nPochoir policy error:\n");
+        printf("Klein bottle topology is only supported for 2D stencils.\n");
+        exit(1);
+    }
+    for (int i = 0; i < N_RANK; ++i) {
+        if (policy.dim_topology[i] == POCHOIR_DIM_TWISTED && (N_RANK != 2 || i != 0)) {
+            printf("\nPochoir policy error:\n");
+            printf("Only dimension 0 of a 2D stencil can be twisted.\n");
+            exit(1);
+        }
+    }
+    return;
+}
+
 template <int N_RANK> template <typename T_Array> 
 void Pochoir<N_RANK>::getPhysDomainFromArray(T_Array & arr) {
     /* get the physical grid */
@@ -157,18 +299,71 @@ void Pochoir<N_RANK>::cmpPhysDomainFromArray(T_Array & arr) {
     }
 }
 
-template <int N_RANK> template <typename T>
-void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK> & arr) {
+template <int N_RANK> template <typename T, typename I, typename B>
+bool Pochoir<N_RANK>::knownArray(Pochoir_Array<T, N_RANK, I, B> & arr) const {
+    for (int i = 0; i < num_arr_; ++i) {
+        if (arr_list_[i] == (void *)&arr)
+            return true;
+    }
+    return false;
+}
+
+template <int N_RANK> template <typename T, typename I, typename B>
+void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK, I, B> & arr) {
     if (!regShapeFlag) {
         cout << "Please register Shape before register Array!" << endl;
         exit(1);
     }
+    /* an array registered again (e.g. by registerBoundaryFn) keeps the
+     * shape, and so the toggle, it has been allocated with
+     */
+    if (!knownArray(arr))
+        arr.Register_Shape(shape_, shape_size_);
+    addArray(arr);
+}
 
-    if (num_arr_ == 0) {
-        arr_type_size_ = sizeof(T);
+template <int N_RANK> template <typename T, typename I, typename B, size_t N_SIZE>
+void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK, I, B> & arr, Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
+    if (!regShapeFlag) {
+        cout << "Please register Shape before register Array!" << endl;
+        exit(1);
+    }
+    if (knownArray(arr)) {
+        printf("Pochoir registration error:\n");
+        printf("A Pochoir array can only be registered with one shape!\n");
+        exit(1);
+    }
+    arr.Register_Shape(shape);
+    addShape(shape, N_SIZE);
+    addArray(arr);
+}
+
+template <int N_RANK> template <typename T, typename I, typename B>
+void Pochoir<N_RANK>::addArray(Pochoir_Array<T, N_RANK, I, B> & arr) {
+    if (!knownArray(arr)) {
+        if (num_arr_ == ARRAY_SIZE) {
+            printf("Pochoir registration error:\n");
+            printf("More than %d Pochoir arrays registered!\n", ARRAY_SIZE);
+            exit(1);
+        }
+        /* a bit-packed array counts as a byte per point */
+        const int l_type_size = Pochoir_Array<T, N_RANK, I, B>::layout::bits ? 1 : (int)sizeof(T);
+        if (num_arr_ == 0)
+            arr_type_size_ = l_type_size;
+        arr_list_[num_arr_] = (void *)&arr;
+        arr_bytes_ += l_type_size * arr.slots();
         ++num_arr_;
+        if (arr.has_halo()) {
+            halo_arr_[num_halo_++].set(arr);
+            for (int i = 0; i < N_RANK; ++i)
+                halo_[i] = max(halo_[i], arr.halo(i));
+            /* Run_Obase(T, f) now walks the boundary zoids too */
+            plans_.clear();
+        }
+        if (arr.file_backed())
+            file_arr_[num_file_++].set(arr);
 #if DEBUG
-        printf("arr_type_size = %d\n", arr_type_size_);
+        printf("arr_type_size = %d, bytes per point = %d\n", l_type_size, arr_bytes_);
 #endif
     } 
     if (!regPhysDomainFlag) {
@@ -176,47 +371,75 @@ void Pochoir<N_RANK>::Register_Array(Pochoir_Array<T, N_RANK> & arr) {
     } else {
         cmpPhysDomainFromArray(arr);
     }
-    arr.Register_Shape(shape_, shape_size_);
-#if 0
-    arr.set_slope(slope_);
-    arr.set_toggle(toggle_);
-    arr.alloc_mem();
-#endif
     regArrayFlag = true;
 }
 
 template <int N_RANK> template <size_t N_SIZE>
 void Pochoir<N_RANK>::Register_Shape(Pochoir_Shape<N_RANK> (& shape)[N_SIZE]) {
-    /* currently we just get the slope_[] and toggle_ out of the shape[] */
+    /* this shape is used by all arrays registered without their own */
     shape_ = new Pochoir_Shape<N_RANK>[N_SIZE];
     shape_size_ = N_SIZE;
-    int l_min_time_shift=0, l_max_time_shift=0, depth=0;
     for (int i = 0; i < N_SIZE; ++i) {
+        for (int r = 0; r < N_RANK+1; ++r) {
+            shape_[i].shift[r] = shape[i].shift[r];
+        }
+    }
+    addShape(shape_, shape_size_);
+    regShapeFlag = true;
+}
+
+/* merge the dependencies of one more shape into time_shift_, toggle_ and
+ * the slopes, which cover the union of all registered shapes
+ */
+template <int N_RANK>
+void Pochoir<N_RANK>::addShape(Pochoir_Shape<N_RANK> const * shape, int shape_size) {
+    int l_min_time_shift=0, l_max_time_shift=0, depth=0;
+    for (int i = 0; i < shape_size; ++i) {
         if (shape[i].shift[0] < l_min_time_shift)
             l_min_time_shift = shape[i].shift[0];
         if (shape[i].shift[0] > l_max_time_shift)
             l_max_time_shift = shape[i].shift[0];
-        for (int r = 0; r < N_RANK+1; ++r) {
-            shape_[i].shift[r] = shape[i].shift[r];
-        }
     }
     depth = l_max_time_shift - l_min_time_shift;
-    time_shift_ = 0 - l_min_time_shift;
-    toggle_ = depth + 1;
-    for (int i = 0; i < N_SIZE; ++i) {
+    /* the toggle of the arrays using this shape */
+    const int l_toggle = depth + 1;
+    time_shift_ = max(time_shift_, 0 - l_min_time_shift);
+    toggle_ = max(toggle_, l_toggle);
+    for (int i = 0; i < shape_size; ++i) {
+        /* a read of x + shift, l_dt time steps back, the written point
+         * itself has l_dt == 0
+         */
+        const int l_dt = l_max_time_shift - shape[i].shift[0];
+        if (l_dt == 0)
+            continue;
+        /* the toggled arrays keep only l_toggle time steps, so writing x
+         * at t overwrites x at t - l_toggle, which is still read at
+         * t - l_toggle + l_dt from x - shift: the mirrored reach over
+         * l_gap time steps
+         */
+        const int l_gap = l_toggle - l_dt;
         for (int r = 0; r < N_RANK; ++r) {
-//             slope_[r] = max(slope_[r], abs((int)ceil((float)shape[i].shift[r+1]/(l_max_time_shift - shape[i].shift[0]))));
-            slope_[r] = max(slope_[r], abs((int)ceil((float)shape[i].shift[N_RANK-r]/(l_max_time_shift - shape[i].shift[0]))));
+            const int l_shift = shape[i].shift[N_RANK-r];
+            if (l_shift < 0) {
+                lslope_[r] = max(lslope_[r], (-l_shift + l_dt - 1) / l_dt);
+                rslope_[r] = max(rslope_[r], (-l_shift + l_gap - 1) / l_gap);
+            } else {
+                rslope_[r] = max(rslope_[r], (l_shift + l_dt - 1) / l_dt);
+                lslope_[r] = max(lslope_[r], (l_shift + l_gap - 1) / l_gap);
+            }
         }
     }
+    for (int r = 0; r < N_RANK; ++r)
+        slope_[r] = max(lslope_[r], rslope_[r]);
+    /* recorded plans were cut with the old slopes */
+    plans_.clear();
 #if DEBUG 
     cout << "time_shift_ = " << time_shift_ << ", toggle = " << toggle_ << endl;
     for (int r = 0; r < N_RANK; ++r) {
-        printf("slope[%d] = %d, ", r, slope_[r]);
+        printf("slope[%d] = %d (left %d, right %d), ", r, slope_[r], lslope_[r], rslope_[r]);
     }
     printf("\n");
 #endif
-    regShapeFlag = true;
 }
 
 template <int N_RANK> template <typename Domain>
@@ -334,19 +557,44 @@ void Pochoir<N_RANK>::Register_Domain(Domain const & r_i) {
 /* Executable Spec */
 template <int N_RANK> template <typename BF>
 void Pochoir<N_RANK>::Run(int timestep, BF const & bf) {
+    Run(timestep, bf, policy_);
+}
+
+template <int N_RANK> template <typename BF>
+void Pochoir<N_RANK>::Run(int timestep, BF const & bf, Pochoir_Policy const & policy) {
+    timestep_ = 0;
+    Advance(timestep, bf, policy);
+}
+
+template <int N_RANK> template <typename BF>
+void Pochoir<N_RANK>::Advance(int steps, BF const & bf) {
+    Advance(steps, bf, policy_);
+}
+
+template <int N_RANK> template <typename BF>
+void Pochoir<N_RANK>::Advance(int steps, BF const & bf, Pochoir_Policy const & policy) {
+    if (steps <= 0)
+        return;
     /* this version uses 'f' to compute interior region, 
      * and 'bf' to compute boundary region
      */
-    Algorithm<N_RANK> algor(slope_);
+    Algorithm<N_RANK> algor(lslope_, rslope_);
     algor.set_phys_grid(phys_grid_);
-    algor.set_thres(arr_type_size_);
-    timestep_ = timestep;
+    algor.set_thres(arr_type_size_, bytesPerPoint());
+    checkPolicy(policy);
+    algor.set_policy(policy);
+    const int t0 = timestep_, t1 = timestep_ + steps;
     /* base_case_kernel() will mimic exact the behavior of serial nested loop!
     */
     checkFlags();
-    inRun = true;
-    algor.base_case_kernel_boundary(0 + time_shift_, timestep + time_shift_, logic_grid_, bf);
-    inRun = false;
+#ifdef CHECK_SHAPE
+    pochoir_shape_check_.in_run = true;
+#endif
+    algor.base_case_kernel_boundary(t0 + time_shift_, t1 + time_shift_, logic_grid_, bf);
+#ifdef CHECK_SHAPE
+    pochoir_shape_check_.in_run = false;
+#endif
+    timestep_ = t1;
     // algor.sim_bicut_zero(0 + time_shift_, timestep + time_shift_, logic_grid_, bf);
     /* obase_boundary_p() is a parallel divide-and-conquer algorithm, which checks
      * boundary for every point
@@ -357,106 +605,458 @@ void Pochoir<N_RANK>::Run(int timestep, BF const & bf) {
 /* safe/non-safe ExecSpec */
 template <int N_RANK> template <typename F, typename BF>
 void Pochoir<N_RANK>::Run(int timestep, F const & f, BF const & bf) {
-    Algorithm<N_RANK> algor(slope_);
+    Run(timestep, f, bf, policy_);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Run(int timestep, F const & f, BF const & bf, Pochoir_Policy const & policy) {
+    timestep_ = 0;
+    Advance(timestep, f, bf, policy);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Advance(int steps, F const & f, BF const & bf) {
+    Advance(steps, f, bf, policy_);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Advance(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy) {
+    if (steps <= 0)
+        return;
+    Algorithm<N_RANK> algor(lslope_, rslope_);
     algor.set_phys_grid(phys_grid_);
-    algor.set_thres(arr_type_size_);
+    algor.set_thres(arr_type_size_, bytesPerPoint());
+    checkPolicy(policy);
+    algor.set_policy(tunedPolicy(policy, 'r'));
     /* this version uses 'f' to compute interior region, 
      * and 'bf' to compute boundary region
      */
-    timestep_ = timestep;
+    const int t0 = timestep_, t1 = timestep_ + steps;
     checkFlags();
+    Pochoir_Advise_Kernel<N_RANK, F> l_f(f, file_arr_, num_file_);
+    Pochoir_Advise_Kernel<N_RANK, BF> l_bf(bf, file_arr_, num_file_);
+    if (policy.cache_plan) {
+        Pochoir_Plan<N_RANK> const & l_plan = getPlan('r', t0, t1, algor, policy, [&](Pochoir_Plan<N_RANK> & plan) {
+            walkBoundary(algor, policy, 0, t1 - t0, Pochoir_Plan_Recorder<N_RANK>(&plan, POCHOIR_PLAN_INTERIOR), Pochoir_Plan_Recorder<N_RANK>(&plan, POCHOIR_PLAN_BOUNDARY));
+        });
+        pochoir_parallel_region([&]{ l_plan.replay([&](Pochoir_Plan_Leaf<N_RANK> const & l_leaf) {
+            if (l_leaf.kind == POCHOIR_PLAN_BOUNDARY)
+                algor.base_case_kernel_boundary(t0 + l_leaf.t0, t0 + l_leaf.t1, l_leaf.grid, l_bf);
+            else
+                algor.base_case_kernel_interior(t0 + l_leaf.t0, t0 + l_leaf.t1, l_leaf.grid, l_f);
+        }); });
+        timestep_ = t1;
+        return;
+    }
 //#pragma isat marker M2_begin
-#if BICUT
-#if 1
-    algor.walk_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#else
-    algor.sim_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#endif
-#else
-    algor.walk_ncores_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#endif
+    pochoir_parallel_region([&]{ walkBoundary(algor, policy, t0, t1, l_f, l_bf); });
 //#pragma isat marker M2_end
+    timestep_ = t1;
 }
 
 /* obase for zero-padded area! */
 template <int N_RANK> template <typename F>
 void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f) {
-    Algorithm<N_RANK> algor(slope_);
+    Run_Obase(timestep, f, policy_);
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f, Pochoir_Policy const & policy) {
+    timestep_ = 0;
+    Advance_Obase(timestep, f, policy);
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::Advance_Obase(int steps, F const & f) {
+    Advance_Obase(steps, f, policy_);
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::Advance_Obase(int steps, F const & f, Pochoir_Policy const & policy) {
+    if (steps <= 0)
+        return;
+    if (num_halo_ > 0) {
+        /* 'f' runs on the boundary zoids as well, reading the halos, the
+         * walk with boundary zoids is needed to cut the domain as a torus
+         */
+        checkHalo(policy);
+        for (int i = 0; i < num_halo_; ++i)
+            halo_arr_[i].fill_(halo_arr_[i].arr_);
+        Pochoir_Halo_Kernel<N_RANK, F> l_f(f, phys_grid_, halo_, halo_arr_, num_halo_);
+        advanceObase(steps, l_f, l_f, policy, 'o');
+        return;
+    }
+    Algorithm<N_RANK> algor(lslope_, rslope_);
     algor.set_phys_grid(phys_grid_);
-    algor.set_thres(arr_type_size_);
-    timestep_ = timestep;
+    algor.set_thres(arr_type_size_, bytesPerPoint());
+    checkPolicy(policy);
+    algor.set_policy(tunedPolicy(policy, 'o'));
+    const int t0 = timestep_, t1 = timestep_ + steps;
     checkFlags();
-#if BICUT
-#if 0
-    fprintf(stderr, "Call obase_bicut\n");
-#pragma isat marker M2_begin
-    algor.obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
-#pragma isat marker M2_end
-#else
-//     fprintf(stderr, "Call shorter_duo_sim_obase_bicut\n");
+    Pochoir_Advise_Kernel<N_RANK, F> l_f(f, file_arr_, num_file_);
+    if (policy.cache_plan) {
+        Pochoir_Plan<N_RANK> const & l_plan = getPlan('o', t0, t1, algor, policy, [&](Pochoir_Plan<N_RANK> & plan) {
+            walkObase(algor, policy, 0, t1 - t0, Pochoir_Plan_Recorder<N_RANK>(&plan, POCHOIR_PLAN_OBASE));
+        });
+        pochoir_parallel_region([&]{ l_plan.replay([&](Pochoir_Plan_Leaf<N_RANK> const & l_leaf) {
+            l_f(t0 + l_leaf.t0, t0 + l_leaf.t1, l_leaf.grid);
+        }); });
+        timestep_ = t1;
+        return;
+    }
 //#pragma isat marker M2_begin
-   // algor.sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
-#if 1
-    // printf("shorter_duo_sim_obase_bicut!\n");
-    algor.shorter_duo_sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
-#else
-    printf("stevenj!\n");
-    algor.stevenj(0+time_shift_, timestep+time_shift_, logic_grid_, f);
-#endif
-    // algor.duo_sim_obase_bicut(0+time_shift_, timestep+time_shift_, logic_grid_, f);
+    pochoir_parallel_region([&]{ walkObase(algor, policy, t0, t1, l_f); });
 //#pragma isat marker M2_end
+    timestep_ = t1;
 #if STAT
     for (int i = 1; i < SUPPORT_RANK; ++i) {
         fprintf(stderr, "sim_count_cut[%d] = %ld\n", i, algor.sim_count_cut[i].get_value());
     }
 #endif
-#endif
-#else
-    algor.obase_m(0+time_shift_, timestep+time_shift_, logic_grid_, f);
-#endif
+}
+
+template <int N_RANK>
+void Pochoir<N_RANK>::checkHalo(Pochoir_Policy const & policy) {
+    char const * l_error = NULL;
+    if (num_halo_ != num_arr_)
+        l_error = "Either all or none of the arrays of a Pochoir object have halos.";
+    else if (policy.topology != POCHOIR_TOPOLOGY_TORUS || policy.dim_topology[0] == POCHOIR_DIM_TWISTED)
+        l_error = "Halos are only supported for the torus topology.";
+    for (int i = 0; i < N_RANK; ++i) {
+        if (logic_grid_.x0[i] != phys_grid_.x0[i] || logic_grid_.x1[i] != phys_grid_.x1[i])
+            l_error = "Halos need the domain to cover the whole array.";
+    }
+    if (l_error != NULL) {
+        printf("\nPochoir halo error:\n");
+        printf("%s\n", l_error);
+        exit(1);
+    }
 }
 
 /* obase for interior and ExecSpec for boundary */
 template <int N_RANK> template <typename F, typename BF>
 void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f, BF const & bf) {
+    Run_Obase(timestep, f, bf, policy_);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Run_Obase(int timestep, F const & f, BF const & bf, Pochoir_Policy const & policy) {
+    timestep_ = 0;
+    Advance_Obase(timestep, f, bf, policy);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Advance_Obase(int steps, F const & f, BF const & bf) {
+    Advance_Obase(steps, f, bf, policy_);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Advance_Obase(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy) {
+    advanceObase(steps, f, bf, policy, 'b');
+}
+
+/* 'kind' tells the tuning entry and the plan apart, see getPlan() */
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::advanceObase(int steps, F const & f, BF const & bf, Pochoir_Policy const & policy, char kind) {
+    if (steps <= 0)
+        return;
 	// Commented out to remove warning.    
 	// int l_total_points = 1;
-    Algorithm<N_RANK> algor(slope_);
+    Algorithm<N_RANK> algor(lslope_, rslope_);
     algor.set_phys_grid(phys_grid_);
-    algor.set_thres(arr_type_size_);
+    algor.set_thres(arr_type_size_, bytesPerPoint());
+    checkPolicy(policy);
+    algor.set_policy(tunedPolicy(policy, kind));
     /* this version uses 'f' to compute interior region, 
      * and 'bf' to compute boundary region
      */
-    timestep_ = timestep;
+    const int t0 = timestep_, t1 = timestep_ + steps;
     checkFlags();
-#if BICUT
-#if 0
-    fprintf(stderr, "Call obase_bicut_boundary_P\n");
-#pragma isat marker M2_begin
-    algor.obase_bicut_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#pragma isat marker M2_end
-#else
-//    fprintf(stderr, "Call sim_obase_bicut_P\n");
+    Pochoir_Advise_Kernel<N_RANK, F> l_f(f, file_arr_, num_file_);
+    Pochoir_Advise_Kernel<N_RANK, BF> l_bf(bf, file_arr_, num_file_);
+    if (policy.cache_plan) {
+        Pochoir_Plan<N_RANK> const & l_plan = getPlan(kind, t0, t1, algor, policy, [&](Pochoir_Plan<N_RANK> & plan) {
+            walkObase(algor, policy, 0, t1 - t0, Pochoir_Plan_Recorder<N_RANK>(&plan, POCHOIR_PLAN_OBASE), Pochoir_Plan_Recorder<N_RANK>(&plan, POCHOIR_PLAN_BOUNDARY));
+        });
+        pochoir_parallel_region([&]{ l_plan.replay([&](Pochoir_Plan_Leaf<N_RANK> const & l_leaf) {
+            if (l_leaf.kind == POCHOIR_PLAN_BOUNDARY)
+                algor.base_case_kernel_boundary(t0 + l_leaf.t0, t0 + l_leaf.t1, l_leaf.grid, l_bf);
+            else
+                l_f(t0 + l_leaf.t0, t0 + l_leaf.t1, l_leaf.grid);
+        }); });
+        timestep_ = t1;
+        return;
+    }
 //#pragma isat marker M2_begin
-#if 1
-    // printf("shorter_duo_sim_obase_bicut_p!\n");
-    algor.shorter_duo_sim_obase_bicut_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#else
-    printf("stevenj_p!\n");
-    algor.stevenj_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-#endif
+    pochoir_parallel_region([&]{ walkObase(algor, policy, t0, t1, l_f, l_bf); });
 //#pragma isat marker M2_end
+    timestep_ = t1;
 #if STAT
     for (int i = 1; i < SUPPORT_RANK; ++i) {
         fprintf(stderr, "sim_count_cut[%d] = %ld\n", i, algor.sim_count_cut[i].get_value());
     }
 #endif
+}
+
+template <int N_RANK> template <typename R, typename P, typename A>
+int Pochoir<N_RANK>::runUntil(int every, int max_steps, R & red, P const & pred, A const & advance) {
+    if (every <= 0) {
+        printf("\nPochoir error:\n");
+        printf("Run_Until() needs a checkpoint interval > 0, got %d.\n", every);
+        exit(1);
+    }
+    timestep_ = 0;
+    while (timestep_ < max_steps) {
+        int l_steps = min(every, max_steps - timestep_);
+        red.reset();
+        /* the checkpoint is the last time step of the window, in the 
+         * time of the kernels
+         */
+        advance(l_steps, timestep_ + l_steps - 1 + time_shift_);
+        if (pred(red.value()))
+            break;
+    }
+    return timestep_;
+}
+
+template <int N_RANK> template <typename BF, typename R, typename P>
+int Pochoir<N_RANK>::Run_Until(int every, int max_steps, BF const & bf, R & red, P const & pred) {
+    return runUntil(every, max_steps, red, pred, [&](int steps, int t) {
+        Advance(steps, pochoir_reduce_kernel(bf, red, t));
+    });
+}
+
+template <int N_RANK> template <typename F, typename BF, typename R, typename P>
+int Pochoir<N_RANK>::Run_Until(int every, int max_steps, F const & f, BF const & bf, R & red, P const & pred) {
+    return runUntil(every, max_steps, red, pred, [&](int steps, int t) {
+        Advance(steps, pochoir_reduce_kernel(f, red, t), pochoir_reduce_kernel(bf, red, t));
+    });
+}
+
+template <int N_RANK> template <typename F, typename R, typename P>
+int Pochoir<N_RANK>::Run_Until_Obase(int every, int max_steps, F const & f, R & red, P const & pred) {
+    return runUntil(every, max_steps, red, pred, [&](int steps, int t) {
+        Advance_Obase(steps, pochoir_reduce_kernel(f, red, t));
+    });
+}
+
+template <int N_RANK> template <typename F, typename BF, typename R, typename P>
+int Pochoir<N_RANK>::Run_Until_Obase(int every, int max_steps, F const & f, BF const & bf, R & red, P const & pred) {
+    return runUntil(every, max_steps, red, pred, [&](int steps, int t) {
+        Advance_Obase(steps, pochoir_reduce_kernel(f, red, t), pochoir_reduce_kernel(bf, red, t));
+    });
+}
+
+/* dispatch of the walkers on policy.algor, also used for recording plans */
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::walkBoundary(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f, BF const & bf) {
+    if (policy.algor == POCHOIR_ALGOR_NCORES)
+        algor.walk_ncores_boundary_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+    else
+        algor.walk_bicut_boundary_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::walkObase(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f) {
+    switch (policy.algor) {
+        case POCHOIR_ALGOR_DUO_SIM:
+            algor.duo_sim_obase_bicut(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+        case POCHOIR_ALGOR_SIM:
+            algor.sim_obase_bicut(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+        case POCHOIR_ALGOR_STEVENJ:
+            algor.stevenj(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+        case POCHOIR_ALGOR_BICUT:
+            algor.obase_bicut(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+        case POCHOIR_ALGOR_NCORES:
+            algor.obase_m(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+        default:
+            algor.shorter_duo_sim_obase_bicut(t0+time_shift_, t1+time_shift_, logic_grid_, f);
+            break;
+    }
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::walkObase(Algorithm<N_RANK> & algor, Pochoir_Policy const & policy, int t0, int t1, F const & f, BF const & bf) {
+    switch (policy.algor) {
+        case POCHOIR_ALGOR_DUO_SIM:
+            algor.duo_sim_obase_bicut_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+        case POCHOIR_ALGOR_SIM:
+            algor.sim_obase_bicut_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+        case POCHOIR_ALGOR_STEVENJ:
+            algor.stevenj_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+        case POCHOIR_ALGOR_BICUT:
+            algor.obase_bicut_boundary_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+        case POCHOIR_ALGOR_NCORES:
+            algor.obase_boundary_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+        default:
+            algor.shorter_duo_sim_obase_bicut_p(t0+time_shift_, t1+time_shift_, logic_grid_, f, bf);
+            break;
+    }
+}
+
+/* the plan of this entry point ('r' Run(f, bf), 'o' Run_Obase(f), 
+ * 'b' Run_Obase(f, bf)) for the current grid, policy, thresholds and a
+ * window of t1 - t0 time steps, record(plan) is invoked to record it if
+ * it is not cached yet. The decomposition only depends on the length
+ * of the window, so plans are recorded for the window starting at time 0
+ * and shifted by t0 on replay.
+ */
+template <int N_RANK> template <typename R>
+Pochoir_Plan<N_RANK> const & Pochoir<N_RANK>::getPlan(char kind, int t0, int t1, Algorithm<N_RANK> const & algor, Pochoir_Policy const & policy, R const & record) {
+    std::vector<int> l_key;
+    l_key.push_back(kind);
+    l_key.push_back(t1 - t0);
+    l_key.push_back(policy.algor);
+    l_key.push_back(policy.spawn);
+    l_key.push_back(policy.topology);
+    l_key.push_back(pochoir_get_nworkers());
+    l_key.push_back(algor.dt_thres());
+    for (int i = 0; i < N_RANK; ++i) {
+        l_key.push_back(algor.dx_thres(i));
+        l_key.push_back(policy.dim_topology[i]);
+        l_key.push_back(logic_grid_.x0[i]);
+        l_key.push_back(logic_grid_.x1[i]);
+        l_key.push_back(phys_grid_.x0[i]);
+        l_key.push_back(phys_grid_.x1[i]);
+    }
+    typename std::map<std::vector<int>, Pochoir_Plan<N_RANK> >::iterator it = plans_.find(l_key);
+    if (it != plans_.end())
+        return it->second;
+    Pochoir_Plan<N_RANK> & l_plan = plans_[l_key];
+    pochoir_begin_record();
+    record(l_plan);
+    pochoir_end_record();
+    l_plan.finalize();
+#if DEBUG
+    printf("Pochoir plan recorded : %d leaves in %d stages\n", l_plan.size(), l_plan.stages());
 #endif
-#else
-//#pragma isat marker M2_begin
-    algor.obase_boundary_p(0+time_shift_, timestep+time_shift_, logic_grid_, f, bf);
-//#pragma isat marker M2_end
-#endif
+    return l_plan;
+}
+
+template <int N_RANK>
+std::string Pochoir<N_RANK>::tuneKey(Pochoir_Policy const & policy, char kind) {
+    return tune_key<N_RANK>(kind, policy.algor, lslope_, rslope_, toggle_, bytesPerPoint(), logic_grid_, pochoir_get_nworkers());
+}
+
+/* fill the zero thresholds of 'policy' from the tuning file, 'kind' tells
+ * the entry point apart : 'r' Run(f, bf), 'o' Run_Obase(f), 'b' Run_Obase(f, bf)
+ */
+template <int N_RANK>
+Pochoir_Policy Pochoir<N_RANK>::tunedPolicy(Pochoir_Policy const & policy, char kind) {
+    Pochoir_Policy l_policy = policy;
+    Pochoir_Tune_Entry l_entry;
+    if (!policy.use_tune_db || !Pochoir_Tune_DB::instance().lookup(tuneKey(policy, kind), l_entry))
+        return l_policy;
+    if ((int)l_entry.dx_thres.size() != N_RANK) {
+        printf("Pochoir tuning: malformed entry for %s in %s, ignored\n", tuneKey(policy, kind).c_str(), Pochoir_Tune_DB::instance().file().c_str());
+        return l_policy;
+    }
+    if (l_policy.dt_thres == 0)
+        l_policy.dt_thres = l_entry.dt_thres;
+    for (int i = 0; i < N_RANK; ++i) {
+        if (l_policy.dx_thres[i] == 0)
+            l_policy.dx_thres[i] = l_entry.dx_thres[N_RANK-1-i];
+    }
+    return l_policy;
+}
+
+/* coordinate search over dt_thres, dx_thres[N_RANK-1], ..., dx_thres[0] :
+ * each threshold is in turn doubled and halved, a move is kept if it is
+ * faster by at least POCHOIR_TUNE_GAIN, until one round brings no gain.
+ * The search starts from the thresholds the run would use right now.
+ */
+template <int N_RANK> template <typename R>
+void Pochoir<N_RANK>::tuneThres(int timestep, char kind, R const & run) {
+    checkFlags();
+    checkPolicy(policy_);
+    Algorithm<N_RANK> l_algor(lslope_, rslope_);
+    l_algor.set_phys_grid(phys_grid_);
+    l_algor.set_thres(arr_type_size_, bytesPerPoint());
+    l_algor.set_policy(tunedPolicy(policy_, kind));
+
+    Pochoir_Policy l_best = policy_;
+    l_best.use_tune_db = false;
+    l_best.dt_thres = l_algor.dt_thres();
+    for (int i = 0; i < N_RANK; ++i)
+        l_best.dx_thres[i] = l_algor.dx_thres(i);
+
+    auto l_measure = [&](Pochoir_Policy const & l_policy) {
+        double l_min = 0;
+        for (int r = 0; r < POCHOIR_TUNE_REPEAT; ++r) {
+            struct timeval l_start, l_end;
+            gettimeofday(&l_start, 0);
+            run(l_policy);
+            gettimeofday(&l_end, 0);
+            double l_time = tdiff(&l_end, &l_start);
+            if (r == 0 || l_time < l_min)
+                l_min = l_time;
+        }
+        return l_min;
+    };
+
+    double l_best_time = l_measure(l_best);
+    for (int round = 0; round < POCHOIR_TUNE_ROUNDS; ++round) {
+        bool l_improved = false;
+        /* i == N_RANK stands for dt_thres */
+        for (int i = N_RANK; i >= 0; --i) {
+            int & l_cur = (i == N_RANK) ? l_best.dt_thres : l_best.dx_thres[i];
+            int l_limit = (i == N_RANK) ? timestep : logic_grid_.x1[i] - logic_grid_.x0[i];
+            int l_cand_val[2] = { l_cur * 2, l_cur / 2 };
+            for (int c = 0; c < 2; ++c) {
+                if (l_cand_val[c] < 1 || l_cand_val[c] == l_cur || (c == 0 && l_cur >= l_limit))
+                    continue;
+                Pochoir_Policy l_cand = l_best;
+                if (i == N_RANK)
+                    l_cand.dt_thres = l_cand_val[c];
+                else
+                    l_cand.dx_thres[i] = l_cand_val[c];
+                double l_time = l_measure(l_cand);
+                if (l_time < l_best_time * POCHOIR_TUNE_GAIN) {
+                    l_best = l_cand;
+                    l_best_time = l_time;
+                    l_improved = true;
+                    break;
+                }
+            }
+        }
+        if (!l_improved)
+            break;
+    }
+
+    Pochoir_Tune_Entry l_entry;
+    l_entry.dt_thres = l_best.dt_thres;
+    for (int i = N_RANK-1; i >= 0; --i)
+        l_entry.dx_thres.push_back(l_best.dx_thres[i]);
+    Pochoir_Tune_DB::instance().record(tuneKey(policy_, kind), l_entry);
+    printf("Pochoir tuning: %s : dt_thres = %d, ", tuneKey(policy_, kind).c_str(), l_best.dt_thres);
+    for (int i = N_RANK-1; i >= 0; --i)
+        printf("dx_thres[%d] = %d, ", i, l_best.dx_thres[i]);
+    printf("%.3f ms\n", 1.0e3 * l_best_time);
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Tune(int timestep, F const & f, BF const & bf) {
+    tuneThres(timestep, 'r', [&](Pochoir_Policy const & policy) { Run(timestep, f, bf, policy); });
+}
+
+template <int N_RANK> template <typename F>
+void Pochoir<N_RANK>::Tune_Obase(int timestep, F const & f) {
+    tuneThres(timestep, 'o', [&](Pochoir_Policy const & policy) { Run_Obase(timestep, f, policy); });
+}
+
+template <int N_RANK> template <typename F, typename BF>
+void Pochoir<N_RANK>::Tune_Obase(int timestep, F const & f, BF const & bf) {
+    tuneThres(timestep, 'b', [&](Pochoir_Policy const & policy) { Run_Obase(timestep, f, bf, policy); });
 }
 
 #endif
@@ -28,42 +28,224 @@
 #include <iomanip>
 #include <cstdio>
 #include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <limits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 
 #include "pochoir_range.hpp"
 #include "pochoir_common.hpp"
 #include "pochoir_proxy.hpp"
-#include <cilk/holder.h>
+#include "pochoir_stored.hpp"
+#include "pochoir_bits.hpp"
 
 using namespace std;
 
-template <int DIM>
-inline int cal_index(int const * _idx, int const * _stride) {
-	return (_idx[DIM] * _stride[DIM]) + cal_index<DIM-1>(_idx, _stride);
+/* the widest halo Pochoir_Array::Register_Halo() allocates */
+#define POCHOIR_HALO_MAX 16
+
+/* Pochoir_Array::Register_Padding() : let alloc_mem() choose the padding
+ * of a dimension, so that no stride is a multiple of POCHOIR_PAD_ALIAS
+ * bytes (an eighth of the 4K way of a typical 8-way L1 cache)
+ */
+#define POCHOIR_PAD_AUTO (-1)
+#define POCHOIR_PAD_ALIAS 512
+
+/* order of the points of an array in its storage, see
+ * Pochoir_Array::Register_Tiling() and Pochoir_Array::Register_Morton()
+ */
+enum Pochoir_Storage_Order {
+    POCHOIR_ORDER_ROW_MAJOR = 0,
+    POCHOIR_ORDER_TILED,
+    POCHOIR_ORDER_MORTON
+};
+
+/* the other orders cost the accessors of every array a test, so they are
+ * only compiled in with -DPOCHOIR_MAPPED_ORDER, row-major arrays are
+ * addressed by their strides alone otherwise
+ */
+#ifdef POCHOIR_MAPPED_ORDER
+#define pochoir_mapped(_m) __builtin_expect((_m), 0)
+#else
+#define pochoir_mapped(_m) false
+#endif
+
+/* offset of the point _idx[DIM..0] for the strides _stride[], in the
+ * index type I of the array
+ */
+template <int DIM, typename I>
+inline I cal_index(int const * _idx, I const * _stride) {
+	I l_idx = _idx[0] * _stride[0];
+	for (int i = 1; i <= DIM; ++i)
+		l_idx += _idx[i] * _stride[i];
+	return l_idx;
 }
 
-template <>
-inline int cal_index<0>(int const * _idx, int const * _stride) {
-	/* 0-dim is always the time dimension */
-	return (_idx[0] * _stride[0]);
+/* alignment of Storage<T> : whole pages for arrays of at least a page,
+ * so that the first touch of a slab places its pages, a cache line
+ * otherwise, 2M for transparent huge pages (see pochoir_huge_pages())
+ */
+#define POCHOIR_PAGE_SIZE 4096
+#define POCHOIR_HUGE_PAGE_SIZE (2 << 20)
+/* arrays below this many bytes are initialized on the calling thread */
+#define POCHOIR_FIRST_TOUCH_MIN (1 << 20)
+/* file-backed arrays are advised in runs of rows of at least this many
+ * bytes, see Pochoir_Array::advise()
+ */
+#define POCHOIR_ADVISE_BYTES (1 << 20)
+#define POCHOIR_ADVISE_MEMO 16
+
+/* POCHOIR_HUGE_PAGES=1 asks the kernel to back large arrays with
+ * transparent huge pages
+ */
+static inline bool pochoir_huge_pages() {
+    static const bool l_huge = (getenv("POCHOIR_HUGE_PAGES") != NULL && atoi(getenv("POCHOIR_HUGE_PAGES")) != 0);
+    return l_huge;
 }
 
 template <typename T>
 class Storage {
 	private:
 		T * storage_;
+		long size_;
 		int ref_;
+        /* false for a buffer of the user (see Pochoir_Array::Register_Buffer())
+         * or one handed over by Pochoir_Array::Detach_Buffer(), which is
+         * neither initialized nor destroyed and freed here
+         */
+        bool owned_;
+        /* length of the file mapping (see Pochoir_Array::Register_File()),
+         * 0 for heap memory
+         */
+        size_t map_bytes_;
 	public:
-		inline Storage(int _sz) {
-			storage_ = new T[_sz];
+        /* view _sz elements of the user buffer _buf, without copying them */
+		inline Storage(T * _buf, long _sz) {
+            storage_ = _buf;
+            size_ = _sz;
+            ref_ = 1;
+            owned_ = false;
+            map_bytes_ = 0;
+        }
+
+        /* _sz elements made of _levels time levels, each of _rows rows
+         * of the outermost dimension. The rows are split into one slab per
+         * worker, the way the walkers split the outermost dimension first,
+         * and the slab is initialized in all levels by the same task, so
+         * that its pages are placed on the node of the worker touching them
+         * first rather than all on the node of the calling thread. In NUMA
+         * mode the slab goes to the worker group that the walkers later
+         * spawn the zoids above it to (see pochoir_spawn_near()).
+         */
+		inline Storage(long _sz, int _levels = 1, long _rows = 1) {
+            size_t l_bytes = (size_t)_sz * sizeof(T);
+            size_t l_align = (l_bytes >= POCHOIR_PAGE_SIZE) ? POCHOIR_PAGE_SIZE : POCHOIR_CACHE_LINE;
+            if (pochoir_huge_pages() && l_bytes >= POCHOIR_HUGE_PAGE_SIZE)
+                l_align = POCHOIR_HUGE_PAGE_SIZE;
+            void * l_mem = NULL;
+            if (posix_memalign(&l_mem, max(l_align, sizeof(void *)), max(l_bytes, (size_t)1)) != 0) {
+                printf("Pochoir allocation error:\n");
+                printf("Out of memory allocating %lu bytes!\n", (unsigned long)l_bytes);
+                exit(1);
+            }
+#ifdef MADV_HUGEPAGE
+            if (l_align == POCHOIR_HUGE_PAGE_SIZE)
+                madvise(l_mem, l_bytes, MADV_HUGEPAGE);
+#endif
+			storage_ = (T *)l_mem;
+            size_ = _sz;
 			ref_ = 1;
-			for (int i = 0; i < _sz; ++i)
-				storage_[i] = T();
+            owned_ = true;
+            map_bytes_ = 0;
+            const long l_level_size = _sz / _levels;
+            const long l_row_size = l_level_size / _rows;
+            const int l_slabs = (l_bytes < POCHOIR_FIRST_TOUCH_MIN) ? 1 : (int)min(_rows, (long)pochoir_get_nworkers());
+            T * const l_storage = storage_;
+            Pochoir_Task_Group l_tg;
+            for (int k = 0; k < l_slabs; ++k) {
+                /* rows [k * _rows / l_slabs, (k+1) * _rows / l_slabs) */
+                const long l_begin = (k * _rows / l_slabs) * l_row_size;
+                const long l_end = (k == l_slabs - 1) ? l_level_size : ((k + 1) * _rows / l_slabs) * l_row_size;
+                pochoir_spawn_near(l_tg, k, l_slabs, [=]{
+                    for (int l = 0; l < _levels; ++l) {
+                        T * l_level = l_storage + l * l_level_size;
+                        for (long i = l_begin; i < l_end; ++i)
+                            new (l_level + i) T();
+                    }
+                });
+            }
+            pochoir_sync(l_tg);
+		}
+
+        /* _sz elements in a shared mapping of the file _path, created or
+         * truncated, or of an unlinked temporary file in $TMPDIR if _path
+         * is NULL. The file starts out sparse and zero, which is T() for
+         * the trivial types, so no page is touched here; the kernel pages
+         * the storage in and out as the walk goes. Readahead is turned
+         * off, Pochoir_Advise_Kernel asks for the pages of the next zoid.
+         */
+		inline Storage(long _sz, char const * _path) {
+            size_t l_bytes = max((size_t)_sz * sizeof(T), (size_t)1);
+            int l_fd;
+            if (_path == NULL) {
+                char const * l_dir = getenv("TMPDIR");
+                std::string l_tmpl = std::string((l_dir != NULL && l_dir[0] != 0) ? l_dir : "/tmp") + "/pochoir.XXXXXX";
+                std::vector<char> l_name(l_tmpl.begin(), l_tmpl.end());
+                l_name.push_back(0);
+                l_fd = mkstemp(&l_name[0]);
+                if (l_fd >= 0)
+                    unlink(&l_name[0]);
+                _path = "a temporary file";
+            } else {
+                l_fd = open(_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            }
+            if (l_fd < 0 || ftruncate(l_fd, (off_t)l_bytes) != 0) {
+                printf("Pochoir allocation error:\n");
+                printf("Cannot create %s of %lu bytes for the array storage!\n", _path, (unsigned long)l_bytes);
+                exit(1);
+            }
+            void * l_mem = mmap(NULL, l_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, l_fd, 0);
+            close(l_fd);
+            if (l_mem == MAP_FAILED) {
+                printf("Pochoir allocation error:\n");
+                printf("Cannot map %lu bytes of %s!\n", (unsigned long)l_bytes, _path);
+                exit(1);
+            }
+            madvise(l_mem, l_bytes, MADV_RANDOM);
+			storage_ = (T *)l_mem;
+            size_ = _sz;
+			ref_ = 1;
+            owned_ = true;
+            map_bytes_ = l_bytes;
+            if (!std::is_trivial<T>::value) {
+                for (long i = 0; i < size_; ++i)
+                    new (storage_ + i) T();
+            }
 		}
 
 		inline ~Storage() {
-			delete[] storage_;
+            if (!owned_)
+                return;
+            for (long i = 0; i < size_; ++i)
+                storage_[i].~T();
+            if (map_bytes_ > 0)
+                munmap(storage_, map_bytes_);
+            else
+			    free(storage_);
 		}
 
+        /* hand the elements over to the caller, who frees them with free(),
+         * or with munmap() if file_backed()
+         */
+        inline T * release() {
+            owned_ = false;
+            return storage_;
+        }
+
 		inline void inc_ref() { 
 			++ref_; 
 		}
@@ -76,40 +258,105 @@ class Storage {
 			return ref_; 
 		}
 
-		inline T & operator[] (int _idx) {
+		inline T & operator[] (long _idx) {
 			return storage_[_idx];
 		}
 
-		inline T const & operator[] (int _idx) const {
+		inline T const & operator[] (long _idx) const {
 			return storage_[_idx];
 		}
 
 		T * data() { return storage_; }
+        long size() const { return size_; }
+        bool file_backed() const { return map_bytes_ > 0; }
 };
 
-template <typename T, int N_RANK>
+/* I is the type of the offsets into the storage (strides, total_size(),
+ * the map tables), POCHOIR_INDEX_TYPE unless given : int keeps the
+ * address arithmetic of the kernels in 32 bits, long (see
+ * Pochoir_Array_Large_ND) lets a time slot hold more than 2^31 elements.
+ * The indices of each dimension and grid_info<> stay int.
+ * B is the boundary policy (see Pochoir_Boundary_Fn) : the function
+ * given to Register_Boundary() by default, or a built-in one such as
+ * Pochoir_Boundary_Periodic.
+ */
+template <typename T, int N_RANK, typename I = POCHOIR_INDEX_TYPE, typename B = Pochoir_Boundary_Fn>
 class Pochoir_Array {
+	public:
+        typedef I index_type;
+        /* the boundary policy, Pochoir_Boundary_Fn or a built-in one */
+        typedef B boundary_policy;
+        /* T &, or Pochoir_SoA_Ref<T> & for the structure-of-arrays layout,
+         * which refers to the scratch argument of the accessors
+         */
+        typedef Pochoir_Layout<T> layout;
+        typedef typename layout::reference reference;
+        typedef typename layout::scratch scratch;
 	private:
 		Storage<T> * view_; // real storage of elements
         T * data_; /* begining data pointer of view_, reserved for iterator! */
+        /* data_ in bytes, and the bytes between two planes of the
+         * structure-of-arrays layout (0 for the plain layout)
+         */
+        char * bytes_;
+        long plane_;
 		typedef int size_info[N_RANK];
 		size_info logic_size_; // logical of elements in each dimension
 		size_info logic_start_, logic_end_; 
 		size_info phys_size_; // physical of elements in each dimension
-		size_info stride_; // stride of each dimension
+        typedef I index_info[N_RANK];
+		index_info stride_; // stride of each dimension
         bool allocMemFlag_;
-		int total_size_;
-        int slope_[N_RANK], toggle_;
+		I total_size_;
+        /* halo cells around the array, see Register_Halo() : halo_[i] on
+         * each side of dimension i, data_ points to the element (0, ..., 0)
+         * at offset origin_ into view_
+         */
+        bool haloFlag_;
+        size_info halo_;
+        I origin_;
+        /* padding of each dimension, see Register_Padding() :
+         * pad_[i] elements are added to dimension i of the storage,
+         * POCHOIR_PAD_AUTO lets alloc_mem() choose
+         */
+        bool padFlag_;
+        size_info pad_;
+        /* storage order, see Register_Tiling() and Register_Morton() :
+         * unless mapped_ is false (row-major order), the point
+         * (i_n, ..., i_0) lies at map_[n][i_n] + ... + map_[0][i_0] in a
+         * time slot, the tables cover the halo cells and live in map_block_
+         */
+        Pochoir_Storage_Order order_;
+        size_info tile_;
+        /* the user buffer to be adopted instead of allocating the storage,
+         * see Register_Buffer() : buf_levels_ time steps, buf_stride_ apart
+         */
+        T * buf_;
+        int buf_levels_;
+        long buf_stride_;
+        /* file-backed storage, see Register_File() : file_ is the path
+         * of the file, empty for a temporary one
+         */
+        bool fileFlag_;
+        std::string file_;
+        bool mapped_;
+        I * map_[N_RANK];
+        I * map_block_;
+        int map_size_;
+        /* the time steps kept in memory are rounded up to a power of two
+         * of slots, time step t lives in slot (t & tmask_)
+         */
+        int slope_[N_RANK], toggle_, tmask_;
         Pochoir_Shape<N_RANK> * shape_;
         int shape_size_;
-        typedef T (*BValue_1D)(Pochoir_Array<T, 1> &, int, int);
-        typedef T (*BValue_2D)(Pochoir_Array<T, 2> &, int, int, int);
-        typedef T (*BValue_3D)(Pochoir_Array<T, 3> &, int, int, int, int);
-        typedef T (*BValue_4D)(Pochoir_Array<T, 4> &, int, int, int, int, int);
-        typedef T (*BValue_5D)(Pochoir_Array<T, 5> &, int, int, int, int, int, int);
-        typedef T (*BValue_6D)(Pochoir_Array<T, 6> &, int, int, int, int, int, int, int);
-        typedef T (*BValue_7D)(Pochoir_Array<T, 7> &, int, int, int, int, int, int, int, int);
-        typedef T (*BValue_8D)(Pochoir_Array<T, 8> &, int, int, int, int, int, int, int, int, int);
+        typedef T (*BValue_1D)(Pochoir_Array<T, 1, I, B> &, int, int);
+        typedef T (*BValue_2D)(Pochoir_Array<T, 2, I, B> &, int, int, int);
+        typedef T (*BValue_3D)(Pochoir_Array<T, 3, I, B> &, int, int, int, int);
+        typedef T (*BValue_4D)(Pochoir_Array<T, 4, I, B> &, int, int, int, int, int);
+        typedef T (*BValue_5D)(Pochoir_Array<T, 5, I, B> &, int, int, int, int, int, int);
+        typedef T (*BValue_6D)(Pochoir_Array<T, 6, I, B> &, int, int, int, int, int, int, int);
+        typedef T (*BValue_7D)(Pochoir_Array<T, 7, I, B> &, int, int, int, int, int, int, int, int);
+        typedef T (*BValue_8D)(Pochoir_Array<T, 8, I, B> &, int, int, int, int, int, int, int, int, int);
         BValue_1D bv1_;
         BValue_2D bv2_;
         BValue_3D bv3_;
@@ -118,7 +365,11 @@ class Pochoir_Array {
         BValue_6D bv6_;
         BValue_7D bv7_;
         BValue_8D bv8_;
-        cilk::holder<T, cilk::holder_keep_last> ret_v;
+        /* the value of the points outside of the domain for the
+         * Pochoir_Boundary_Zero and _Constant policies
+         */
+        T bconst_;
+        Pochoir_Holder<T> ret_v;
         // Pochoir_Proxy<T> ret_v;
 	public:
 		/* create array with initial size 
@@ -133,6 +384,16 @@ class Pochoir_Array {
             shape_ = NULL;
             view_ = NULL;
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //            view_ = new Storage<T>(TOGGLE * total_size_);
 //            data_ = view_->data();
@@ -145,9 +406,19 @@ class Pochoir_Array {
             logic_start_[1] = 0; logic_end_[1] = sz1;
 			stride_[1] = sz0; stride_[0] = 1; 
             shape_ = NULL;
-			total_size_ = phys_size_[0] * phys_size_[1];
+			total_size_ = (I)phys_size_[0] * phys_size_[1];
 			view_ = NULL;
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE * total_size_) ;
 //            data_ = view_->data();
@@ -169,6 +440,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //  		  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -191,6 +472,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -214,6 +505,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -238,6 +539,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -263,6 +574,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -289,6 +610,16 @@ class Pochoir_Array {
 			view_ = NULL;
 			/* double the total_size_ because we are using toggle array */
             bv1_ = NULL; bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL;
+            bconst_ = T();
+            haloFlag_ = false; origin_ = 0;
+            padFlag_ = false;
+            tmask_ = 0;
+            bytes_ = NULL; plane_ = 0;
+            order_ = POCHOIR_ORDER_ROW_MAJOR; mapped_ = false;
+            map_block_ = NULL; map_size_ = 0;
+            buf_ = NULL; buf_levels_ = 0; buf_stride_ = 0;
+            fileFlag_ = false;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = 0;
             allocMemFlag_ = false;
 //			  view_ = new Storage<T>(TOGGLE*total_size_) ;
 //            data_ = view_->data();
@@ -297,7 +628,7 @@ class Pochoir_Array {
 		/* Copy constructor -- create another view of the
 		 * same array
 		 */
-		Pochoir_Array (Pochoir_Array<T, N_RANK> const & orig) {
+		Pochoir_Array (Pochoir_Array<T, N_RANK, I, B> const & orig) {
 			total_size_ = orig.total_size();
 			for (int i = 0; i < N_RANK; ++i) {
 				phys_size_[i] = orig.phys_size(i);
@@ -306,24 +637,35 @@ class Pochoir_Array {
                 logic_start_[i] = 0; logic_end_[i] = logic_size_[i];
 			}
 			view_ = NULL;
-			view_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).view();
+			view_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).view();
 			view_->inc_ref();
             /* We also get the BValue function pointer from orig */
-            bv1_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_1D(); 
-            bv2_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_2D(); 
-            bv3_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_3D(); 
-            bv4_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_4D(); 
-            bv5_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_5D(); 
-            bv6_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_6D(); 
-            bv7_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_7D(); 
-            bv8_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_8D(); 
-            data_ = view_->data();
+            bv1_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_1D(); 
+            bv2_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_2D(); 
+            bv3_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_3D(); 
+            bv4_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_4D(); 
+            bv5_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_5D(); 
+            bv6_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_6D(); 
+            bv7_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_7D(); 
+            bv8_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_8D(); 
+            bconst_ = orig.bconst_;
+            haloFlag_ = orig.haloFlag_; origin_ = orig.origin_;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = orig.halo_[i];
+            padFlag_ = orig.padFlag_;
+            toggle_ = orig.toggle_; tmask_ = orig.tmask_;
+            bytes_ = orig.bytes_; plane_ = orig.plane_;
+            map_block_ = NULL;
+            copy_map(orig);
+            buf_ = orig.buf_; buf_levels_ = orig.buf_levels_; buf_stride_ = orig.buf_stride_;
+            fileFlag_ = orig.fileFlag_; file_ = orig.file_;
+            for (int i = 0; i < N_RANK; ++i) pad_[i] = orig.pad_[i];
+            data_ = view_->data() + origin_;
             allocMemFlag_ = true;
             shape_ = NULL;
 		}
 
         /* assignment operator for vector<> */
-		Pochoir_Array<T, N_RANK> & operator= (Pochoir_Array<T, N_RANK> const & orig) {
+		Pochoir_Array<T, N_RANK, I, B> & operator= (Pochoir_Array<T, N_RANK, I, B> const & orig) {
 			total_size_ = orig.total_size();
 			for (int i = 0; i < N_RANK; ++i) {
 				phys_size_[i] = orig.phys_size(i);
@@ -331,18 +673,29 @@ class Pochoir_Array {
 				stride_[i] = orig.stride(i);
 			}
 			view_ = NULL;
-			view_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).view();
+			view_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).view();
 			view_->inc_ref();
             /* We also get the BValue function pointer from orig */
-            bv1_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_1D(); 
-            bv2_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_2D(); 
-            bv3_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_3D(); 
-            bv4_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_4D(); 
-            bv5_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_5D(); 
-            bv6_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_6D(); 
-            bv7_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_7D(); 
-            bv8_ = const_cast<Pochoir_Array<T, N_RANK> &>(orig).bv_8D(); 
-            data_ = view_->data();
+            bv1_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_1D(); 
+            bv2_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_2D(); 
+            bv3_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_3D(); 
+            bv4_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_4D(); 
+            bv5_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_5D(); 
+            bv6_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_6D(); 
+            bv7_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_7D(); 
+            bv8_ = const_cast<Pochoir_Array<T, N_RANK, I, B> &>(orig).bv_8D(); 
+            bconst_ = orig.bconst_;
+            haloFlag_ = orig.haloFlag_; origin_ = orig.origin_;
+            for (int i = 0; i < N_RANK; ++i) halo_[i] = orig.halo_[i];
+            padFlag_ = orig.padFlag_;
+            toggle_ = orig.toggle_; tmask_ = orig.tmask_;
+            bytes_ = orig.bytes_; plane_ = orig.plane_;
+            delete[] map_block_; map_block_ = NULL;
+            copy_map(orig);
+            buf_ = orig.buf_; buf_levels_ = orig.buf_levels_; buf_stride_ = orig.buf_stride_;
+            fileFlag_ = orig.fileFlag_; file_ = orig.file_;
+            for (int i = 0; i < N_RANK; ++i) pad_[i] = orig.pad_[i];
+            data_ = view_->data() + origin_;
             allocMemFlag_ = true;
             shape_ = NULL;
             return *this;
@@ -354,13 +707,47 @@ class Pochoir_Array {
             allocMemFlag_ = false;
             if (shape_ != NULL) 
                 delete[] shape_;
+            delete[] map_block_;
 		}
 
 		inline Storage<T> * view() {
 			return view_;
 		}
 
-        inline T * data() { return data_; }
+        /* the elements of a plain, row-major array, see bytes() for the
+         * other layouts
+         */
+        inline T * data() {
+            if (layout::soa) {
+                printf("Pochoir array layout error:\n");
+                printf("data() of an array in the structure-of-arrays layout, use bytes() and plane()!\n");
+                exit(1);
+            }
+            if (layout::bits) {
+                printf("Pochoir array layout error:\n");
+                printf("data() of a bit-packed array, use bytes() and element()!\n");
+                exit(1);
+            }
+            if (mapped_) {
+                printf("Pochoir array layout error:\n");
+                printf("data() of a tiled or Morton-ordered array, use bytes() and map()!\n");
+                exit(1);
+            }
+            return data_;
+        }
+        /* element (0, ..., 0) of time slot 0 in bytes, the element at index
+         * idx starts layout::bytes(idx) bytes further; its byte at offset
+         * 'off' lies layout::field(off, plane()) bytes into it
+         */
+        inline char * bytes() { return bytes_; }
+        inline long plane() const { return plane_; }
+        /* the element at index idx (time slot included) from bytes() */
+        inline reference element(I _idx, scratch & _s) { return layout::ref(bytes_, _idx, plane_, _s); }
+        inline reference element(I _idx, scratch && _s = scratch()) { return element(_idx, _s); }
+        /* a single value of type T, e.g. the constant boundary value */
+        static inline reference value_ref(T & _v, scratch & _s) { return layout::ref((char *)&_v, 0, layout::word, _s); }
+        /* the element at index idx from a time slot 'slot' of bytes() */
+        static inline reference at(char * _slot, I _idx, long _plane, scratch && _s = scratch()) { return layout::ref(_slot, _idx, _plane, _s); }
         /* return the function pointer which generates the boundary value! */
         BValue_1D bv_1D(void) { return bv1_; }
         BValue_2D bv_2D(void) { return bv2_; }
@@ -383,6 +770,15 @@ class Pochoir_Array {
 
         void unRegister_Boundary(void) { bv1_ = NULL;  bv2_ = NULL; bv3_ = NULL; bv4_ = NULL; bv5_ = NULL; bv6_ = NULL; bv7_ = NULL; bv8_ = NULL;}
 
+        /* the constant of a Pochoir_Boundary_Constant array, the boundary
+         * policy itself is the template argument B
+         */
+        template <typename T2>
+        void Register_Boundary(Pochoir_Boundary_Value<T2> const & _bc) {
+            static_assert(std::is_same<B, Pochoir_Boundary_Constant>::value, "pochoir_boundary_constant() needs an array with the Pochoir_Boundary_Constant policy");
+            bconst_ = _bc.value;
+        }
+
         void Register_Domain(grid_info<N_RANK> initial_grid) {
             for (int i = 0; i < N_RANK; ++i) {
                 logic_start_[i] = initial_grid.x0[i];
@@ -493,7 +889,7 @@ class Pochoir_Array {
                     l_min_time_shift = shape1[i].shift[0];
                 if (shape1[i].shift[0] > l_max_time_shift)
                     l_max_time_shift = shape1[i].shift[0];
-                for (int r = 0; r < N_RANK+1; ++i) {
+                for (int r = 0; r < N_RANK+1; ++r) {
                     shape_[i].shift[r] = shape1[i].shift[r];
                 }
             }
@@ -581,23 +977,621 @@ class Pochoir_Array {
         void set_toggle(int _toggle) { toggle_ = _toggle; }
         void alloc_mem(void) {
             if (!allocMemFlag_) {
-                view_ = new Storage<T>(toggle_*total_size_) ;
-                data_ = view_->data();
+                int l_extent[N_RANK];
+                /* the elements of a time slot, counted in long so that an
+                 * index type too narrow for them is caught below
+                 */
+                long l_slot_size = 1;
+                for (int i = 0; i < N_RANK; ++i)
+                    l_slot_size *= phys_size_[i];
+                if (padFlag_ && order_ != POCHOIR_ORDER_ROW_MAJOR) {
+                    printf("Pochoir padding error:\n");
+                    printf("Register_Padding() does not apply to a tiled or Morton-ordered array!\n");
+                    exit(1);
+                }
+                if (layout::bits && (haloFlag_ || order_ != POCHOIR_ORDER_ROW_MAJOR)) {
+                    printf("Pochoir bit array error:\n");
+                    printf("A bit-packed array is stored in row-major order, without halos!\n");
+                    exit(1);
+                }
+                if (haloFlag_ || padFlag_ || order_ != POCHOIR_ORDER_ROW_MAJOR || layout::bits) {
+                    origin_ = 0;
+                    total_size_ = 1;
+                    l_slot_size = 1;
+                    for (int i = 0; i < N_RANK; ++i) {
+                        /* the halo is as wide as the farthest reach of the shape */
+                        halo_[i] = 0;
+                        for (int j = 0; haloFlag_ && j < shape_size_; ++j)
+                            halo_[i] = max(halo_[i], abs(shape_[j].shift[N_RANK-i]));
+                        if (halo_[i] > POCHOIR_HALO_MAX) {
+                            printf("Pochoir halo error:\n");
+                            printf("The shape reaches %d points away in dimension %d, halos are at most %d wide!\n", halo_[i], i, POCHOIR_HALO_MAX);
+                            exit(1);
+                        }
+                        l_extent[i] = phys_size_[i] + 2 * halo_[i];
+                        if (padFlag_)
+                            l_extent[i] = pad_extent(i, l_extent[i], total_size_);
+                        /* the rows of a bit-packed array start on a word */
+                        if (layout::bits && i == 0)
+                            l_extent[i] = (l_extent[i] + 63) / 64 * 64;
+                        if (order_ != POCHOIR_ORDER_ROW_MAJOR)
+                            l_extent[i] = order_extent(i, l_extent[i]);
+                        stride_[i] = total_size_;
+                        total_size_ *= l_extent[i];
+                        l_slot_size *= l_extent[i];
+                        origin_ += halo_[i] * stride_[i];
+                    }
+                }
+                if (buf_ == NULL)
+                    check_index_range((long)slots() * l_slot_size);
+                if (order_ != POCHOIR_ORDER_ROW_MAJOR) {
+                    /* the map tables take care of the halo */
+                    build_map(l_extent);
+                    origin_ = 0;
+                }
+                tmask_ = slots() - 1;
+                if (buf_ != NULL)
+                    view_ = adopt_buffer();
+                else if (fileFlag_)
+                    view_ = new Storage<T>(layout::size((long)slots()*total_size_), file_.empty() ? (char const *)NULL : file_.c_str());
+                else
+                    view_ = new Storage<T>(layout::size((long)slots()*total_size_), slots(), total_size_/stride_[N_RANK-1]) ;
+                data_ = view_->data() + origin_;
+                bytes_ = (char *)view_->data() + layout::bytes(origin_);
+                plane_ = layout::soa ? layout::bytes((long)slots() * total_size_) : 0;
                 allocMemFlag_ = true;
             }
         }
+
+        /* Allocate halo cells around the array, as wide as the reach of its
+         * shape, so that interior() can be used up to that far outside of
+         * the array. Pochoir::Run_Obase(T, f) keeps them filled according
+         * to the built-in boundary of the array (Pochoir_Boundary_Periodic,
+         * ...), and runs 'f' on the whole domain instead of leaving the
+         * boundary to a boundary kernel.
+         * Must be called before the array is registered.
+         */
+        void Register_Halo(void) {
+            static_assert(B::builtin, "an array with halos needs a built-in boundary (Pochoir_Boundary_Periodic, ...)");
+            if (allocMemFlag_) {
+                printf("Pochoir halo error:\n");
+                printf("Register_Halo() must be called before the array is registered with a Pochoir object!\n");
+                exit(1);
+            }
+            haloFlag_ = true;
+        }
+        bool has_halo(void) const { return haloFlag_; }
+        int halo(int _dim) const { return halo_[_dim]; }
+
+        /* Pad the storage of each dimension but the outermost one, so that
+         * the strides of a power-of-two grid (1024^2, 512^3, ...) do not map
+         * neighbouring rows and planes into the same cache sets. Only the
+         * strides change, the array is still indexed by its logical size
+         * in interior(), operator() and the generated kernels. Without an
+         * argument the padding is chosen automatically, _pad[i] adds that
+         * many elements to dimension i (0 is the unit-stride dimension),
+         * or POCHOIR_PAD_AUTO, _pad[N_RANK-1] must be 0 or POCHOIR_PAD_AUTO.
+         * Must be called before the array is registered.
+         */
+        void Register_Padding(void) {
+            int l_pad[N_RANK];
+            for (int i = 0; i < N_RANK; ++i)
+                l_pad[i] = POCHOIR_PAD_AUTO;
+            Register_Padding(l_pad);
+        }
+        void Register_Padding(int const _pad[N_RANK]) {
+            if (allocMemFlag_) {
+                printf("Pochoir padding error:\n");
+                printf("Register_Padding() must be called before the array is registered with a Pochoir object!\n");
+                exit(1);
+            }
+            if (_pad[N_RANK-1] != 0 && _pad[N_RANK-1] != POCHOIR_PAD_AUTO) {
+                printf("Pochoir padding error:\n");
+                printf("The outermost dimension is not padded, got _pad[%d] = %d!\n", N_RANK-1, _pad[N_RANK-1]);
+                exit(1);
+            }
+            for (int i = 0; i < N_RANK-1; ++i) {
+                if (_pad[i] < 0 && _pad[i] != POCHOIR_PAD_AUTO) {
+                    printf("Pochoir padding error:\n");
+                    printf("Dimension %d cannot be padded by a negative number of elements, got _pad[%d] = %d!\n", i, i, _pad[i]);
+                    exit(1);
+                }
+            }
+            padFlag_ = true;
+            for (int i = 0; i < N_RANK; ++i)
+                pad_[i] = _pad[i];
+        }
+
+        /* extent of dimension _i in the storage, _stride is its stride :
+         * the explicit padding, or for POCHOIR_PAD_AUTO, the extent grown
+         * by a cache line (unit-stride dimension) or by one row / plane
+         * (the others) until the stride of the next dimension is no longer
+         * a multiple of POCHOIR_PAD_ALIAS bytes. The outermost dimension
+         * is left alone, its stride is the size of a time level.
+         */
+        int pad_extent(int _i, int _extent, I _stride) const {
+            if (_i == N_RANK-1)
+                return _extent;
+            if (pad_[_i] != POCHOIR_PAD_AUTO)
+                return _extent + pad_[_i];
+            /* a bit-packed array grows its rows by a word */
+            const int l_unit = (_i != 0) ? 1 : (layout::bits ? 64 : max(1, (int)(POCHOIR_CACHE_LINE / sizeof(T))));
+            for (int k = 0; k < POCHOIR_CACHE_LINE && (layout::bits ? layout::bytes((long)_extent * _stride) : (long)_extent * _stride * (long)sizeof(T)) % POCHOIR_PAD_ALIAS == 0; ++k)
+                _extent += l_unit;
+            return _extent;
+        }
+
+        /* Store the array in tiles of _tile[i] points along dimension i (0
+         * is the unit-stride dimension), the tiles and the points within a
+         * tile in row-major order, so that the neighbours of a point along
+         * the slow dimensions are close in memory and in few pages. Without
+         * an argument a tile fills a page, e.g. 8x8x8 doubles. The extents
+         * are rounded up to whole tiles. Needs -DPOCHOIR_MAPPED_ORDER.
+         * Must be called before the array is registered.
+         */
+        void Register_Tiling(void) {
+            /* split the log2 of the points in a page evenly, the rest to
+             * the unit-stride dimension
+             */
+            int l_bits = 0;
+            while ((2 << l_bits) * sizeof(T) <= POCHOIR_PAGE_SIZE)
+                ++l_bits;
+            int l_tile[N_RANK];
+            for (int i = 0; i < N_RANK; ++i)
+                l_tile[i] = 1 << (l_bits / N_RANK + (i == 0 ? l_bits % N_RANK : 0));
+            Register_Tiling(l_tile);
+        }
+        void Register_Tiling(int const _tile[N_RANK]) {
+            check_order_unallocated("Register_Tiling()");
+            for (int i = 0; i < N_RANK; ++i) {
+                if (_tile[i] < 1) {
+                    printf("Pochoir tiling error:\n");
+                    printf("The tile is %d points wide in dimension %d!\n", _tile[i], i);
+                    exit(1);
+                }
+                tile_[i] = _tile[i];
+            }
+            order_ = POCHOIR_ORDER_TILED;
+        }
+        /* Store the array in Z-order (Morton order) : the bits of the
+         * indices are interleaved, so that every aligned power-of-two
+         * block is contiguous at all scales, like the zoids of the
+         * recursive walk. The extents are rounded up to powers of two.
+         * Needs -DPOCHOIR_MAPPED_ORDER.
+         * Must be called before the array is registered.
+         */
+        void Register_Morton(void) {
+            check_order_unallocated("Register_Morton()");
+            order_ = POCHOIR_ORDER_MORTON;
+        }
+        Pochoir_Storage_Order storage_order(void) const { return order_; }
+        /* true unless the array is stored in row-major order, then the
+         * point (i_n, ..., i_0) of a time slot lies at
+         * map(n)[i_n] + ... + map(0)[i_0] instead of going by stride()
+         */
+        bool mapped(void) const { return pochoir_mapped(mapped_); }
+        I const * map(int _dim) const { return map_[_dim]; }
+
+        void check_order_unallocated(char const * _fn) const {
+#ifndef POCHOIR_MAPPED_ORDER
+            printf("Pochoir storage order error:\n");
+            printf("%s needs the code to be compiled with -DPOCHOIR_MAPPED_ORDER!\n", _fn);
+            exit(1);
+#endif
+            if (allocMemFlag_) {
+                printf("Pochoir storage order error:\n");
+                printf("%s must be called before the array is registered with a Pochoir object!\n", _fn);
+                exit(1);
+            }
+        }
+
+        /* Adopt the user buffer _buf as the storage of the array instead
+         * of allocating one, without copying it : _levels time steps,
+         * _level_stride elements apart, each with the point (i_n, ..., i_0)
+         * at i_n * _stride[n] + ... + i_0 * _stride[0] (0 is the unit-stride
+         * dimension). Without the strides, the time steps are dense
+         * row-major arrays of the size of the array. Time step t lives in
+         * level (t & slot_mask()), so the buffer needs slots() levels, which
+         * is checked when the array is registered. The buffer is neither
+         * initialized nor freed by the array.
+         * Must be called before the array is registered.
+         */
+        void Register_Buffer(T * _buf, int _levels) {
+            long l_stride[N_RANK], l_size = 1;
+            for (int i = 0; i < N_RANK; ++i) {
+                l_stride[i] = l_size;
+                l_size *= phys_size_[i];
+            }
+            Register_Buffer(_buf, _levels, l_stride, l_size);
+        }
+        template <typename S>
+        void Register_Buffer(T * _buf, int _levels, S const _stride[N_RANK], long _level_stride) {
+            if (allocMemFlag_) {
+                printf("Pochoir buffer error:\n");
+                printf("Register_Buffer() must be called before the array is registered with a Pochoir object!\n");
+                exit(1);
+            }
+            if (_buf == NULL || _levels < 1) {
+                printf("Pochoir buffer error:\n");
+                printf("Register_Buffer() needs a buffer of at least one time step!\n");
+                exit(1);
+            }
+            for (int i = 0; i < N_RANK; ++i) {
+                if (_stride[i] < 1) {
+                    printf("Pochoir buffer error:\n");
+                    printf("The stride of dimension %d of the buffer is %ld!\n", i, (long)_stride[i]);
+                    exit(1);
+                }
+                stride_[i] = _stride[i];
+            }
+            if (fileFlag_) {
+                printf("Pochoir buffer error:\n");
+                printf("An array cannot both adopt a user buffer and be file-backed!\n");
+                exit(1);
+            }
+            buf_ = _buf;
+            buf_levels_ = _levels;
+            buf_stride_ = _level_stride;
+        }
+        bool adopted(void) const { return buf_ != NULL; }
+
+        /* Hand the storage over to the caller : the array keeps using it
+         * but no longer frees it, so that the results outlive the array
+         * without being copied out. Returns the start of the storage, time
+         * slot 0 first (see total_size(), stride() and halo()); unless it
+         * was adopted with Register_Buffer(), the caller frees it with free(),
+         * or munmap()s the slots() * total_size() elements if file_backed().
+         */
+        T * Detach_Buffer(void) {
+            if (!allocMemFlag_) {
+                printf("Pochoir buffer error:\n");
+                printf("Detach_Buffer() of an array that is not registered with a Pochoir object yet!\n");
+                exit(1);
+            }
+            return view_->release();
+        }
+
+        /* Keep the storage in a shared mapping of the file _path (created,
+         * or truncated), or of a temporary file without an argument,
+         * instead of the heap, so that all time slots of the array may be
+         * larger than the physical memory. Before each base zoid, the rows
+         * of the outermost dimension that it reaches in every time slot
+         * are asked for with madvise(), see advise(); the storage is zero,
+         * i.e. T() for the trivial types, until it is written.
+         * Must be called before the array is registered.
+         */
+        void Register_File(void) { Register_File(NULL); }
+        void Register_File(char const * _path) {
+            if (allocMemFlag_) {
+                printf("Pochoir file error:\n");
+                printf("Register_File() must be called before the array is registered with a Pochoir object!\n");
+                exit(1);
+            }
+            if (buf_ != NULL) {
+                printf("Pochoir file error:\n");
+                printf("An array cannot both adopt a user buffer and be file-backed!\n");
+                exit(1);
+            }
+            fileFlag_ = true;
+            file_ = (_path != NULL) ? _path : "";
+        }
+        bool file_backed(void) const { return fileFlag_; }
+
+        /* MADV_WILLNEED the rows of the outermost dimension that the zoid
+         * (t0, t1, grid) covers, widened by the slope, in every time slot,
+         * wrapping around the domain. The rows of a tiled or Morton-ordered
+         * array are not contiguous, its pages are left to the kernel.
+         */
+        void advise(int t0, int t1, grid_info<N_RANK> const & grid) const {
+            if (!fileFlag_ || pochoir_mapped(mapped_))
+                return;
+            const int l_dim = N_RANK - 1, l_size = phys_size_[l_dim], l_dt = t1 - t0;
+            int l_lo = min(grid.x0[l_dim], grid.x0[l_dim] + grid.dx0[l_dim] * l_dt) - slope_[l_dim];
+            int l_hi = max(grid.x1[l_dim], grid.x1[l_dim] + grid.dx1[l_dim] * l_dt) + slope_[l_dim];
+            if (l_hi - l_lo >= l_size) {
+                advise_rows(0, l_size);
+                return;
+            }
+            const int l_len = l_hi - l_lo;
+            l_lo = ((l_lo % l_size) + l_size) % l_size;
+            if (l_lo + l_len <= l_size) {
+                advise_rows(l_lo, l_lo + l_len);
+            } else {
+                advise_rows(l_lo, l_size);
+                advise_rows(0, l_lo + l_len - l_size);
+            }
+        }
+        void advise_rows(int _lo, int _hi) const {
+            /* madvise() costs about as much as a small base zoid, so the
+             * rows go in runs of POCHOIR_ADVISE_BYTES, and a worker skips
+             * the runs it asked for lately, which are most of the runs
+             * the next zoids of the walk touch
+             */
+            struct Advised { void const * arr; int run; };
+            static thread_local Advised l_memo[POCHOIR_ADVISE_MEMO];
+            static thread_local int l_next = 0;
+            const long l_row = layout::bytes(stride_[N_RANK-1]);
+            const int l_run = (int)max(1L, POCHOIR_ADVISE_BYTES / max(l_row, 1L));
+            for (int r = _lo / l_run; r * l_run < _hi; ++r) {
+                bool l_seen = false;
+                for (int i = 0; i < POCHOIR_ADVISE_MEMO && !l_seen; ++i)
+                    l_seen = (l_memo[i].arr == (void const *)this && l_memo[i].run == r);
+                if (l_seen)
+                    continue;
+                l_memo[l_next].arr = (void const *)this;
+                l_memo[l_next].run = r;
+                l_next = (l_next + 1) % POCHOIR_ADVISE_MEMO;
+                advise_bytes(r * l_run * l_row, min((r + 1) * l_run, phys_size_[N_RANK-1]) * l_row);
+            }
+        }
+        /* bytes [_begin, _end) past the origin of every time slot (and
+         * every plane of the structure-of-arrays layout)
+         */
+        void advise_bytes(long _begin, long _end) const {
+            const long l_planes = layout::soa ? (long)(sizeof(T) / layout::word) : 1;
+            const uintptr_t l_page = POCHOIR_PAGE_SIZE - 1;
+            const uintptr_t l_first = (uintptr_t)view_->data() & ~l_page;
+            const uintptr_t l_last = (uintptr_t)view_->data() + (uintptr_t)view_->size() * sizeof(T);
+            for (int s = 0; s <= tmask_; ++s) {
+                for (long k = 0; k < l_planes; ++k) {
+                    char const * l_slot = bytes_ + k * plane_ + layout::bytes((long)s * total_size_);
+                    uintptr_t l_begin = max((uintptr_t)(l_slot + _begin) & ~l_page, l_first);
+                    uintptr_t l_end = min((uintptr_t)(l_slot + _end), l_last);
+                    if (l_begin < l_end)
+                        madvise((void *)l_begin, l_end - l_begin, MADV_WILLNEED);
+                }
+            }
+        }
+
+        /* the offsets into a storage of _size elements must fit into the
+         * index type I
+         */
+        static void check_index_range(long _size) {
+            if (_size - 1 > (long)std::numeric_limits<I>::max()) {
+                printf("Pochoir index error:\n");
+                printf("The array holds %ld elements, more than its index type can address, use Pochoir_Array_Large_%dD or -DPOCHOIR_INDEX_TYPE=long!\n", _size, N_RANK);
+                exit(1);
+            }
+        }
+
+        /* the storage of alloc_mem() on the buffer of Register_Buffer() */
+        Storage<T> * adopt_buffer(void) {
+            if (haloFlag_ || padFlag_ || order_ != POCHOIR_ORDER_ROW_MAJOR || layout::soa || layout::bits) {
+                printf("Pochoir buffer error:\n");
+                printf("A user buffer is stored in the plain row-major order, without halos or padding!\n");
+                exit(1);
+            }
+            if (buf_levels_ < slots()) {
+                printf("Pochoir buffer error:\n");
+                printf("The buffer holds %d time steps, the shape of the array needs %d!\n", buf_levels_, slots());
+                exit(1);
+            }
+            long l_span = 1;
+            for (int i = 0; i < N_RANK; ++i)
+                l_span += (long)(phys_size_[i] - 1) * stride_[i];
+            if (l_span > buf_stride_) {
+                printf("Pochoir buffer error:\n");
+                printf("The time steps of the buffer are %ld elements apart, but each one spans %ld!\n", buf_stride_, l_span);
+                exit(1);
+            }
+            check_index_range((long)slots() * buf_stride_);
+            total_size_ = buf_stride_;
+            return new Storage<T>(buf_, (long)slots() * total_size_);
+        }
+
+        /* extent of dimension _i in the storage : whole tiles, or a power
+         * of two for the Morton order
+         */
+        int order_extent(int _i, int _extent) const {
+            if (order_ == POCHOIR_ORDER_TILED)
+                return (_extent + tile_[_i] - 1) / tile_[_i] * tile_[_i];
+            int l_extent = 1;
+            while (l_extent < _extent)
+                l_extent <<= 1;
+            return l_extent;
+        }
+
+        /* fill map_[] for the extents _extent[] of the storage (halos
+         * included), map_[i] is shifted so that map_[i][-halo_[i]] is the
+         * first entry
+         */
+        void build_map(int const * _extent) {
+            map_size_ = 0;
+            for (int i = 0; i < N_RANK; ++i)
+                map_size_ += _extent[i];
+            map_block_ = new I[map_size_];
+            I * l_map = map_block_;
+            if (order_ == POCHOIR_ORDER_TILED) {
+                /* points within a tile, then the tiles, both row-major */
+                I l_inner = 1, l_outer = 1;
+                for (int i = 0; i < N_RANK; ++i)
+                    l_outer *= tile_[i];
+                for (int i = 0; i < N_RANK; ++i) {
+                    for (int x = 0; x < _extent[i]; ++x)
+                        l_map[x] = (x / tile_[i]) * l_outer + (x % tile_[i]) * l_inner;
+                    l_inner *= tile_[i];
+                    l_outer *= _extent[i] / tile_[i];
+                    map_[i] = l_map + halo_[i];
+                    l_map += _extent[i];
+                }
+            } else {
+                /* bit b of index i goes to l_pos[i][b] : round-robin over
+                 * the dimensions that still have bits, low bits first
+                 */
+                int l_bits[N_RANK], l_pos[N_RANK][32], l_next = 0;
+                for (int i = 0; i < N_RANK; ++i) {
+                    l_bits[i] = 0;
+                    while ((1 << l_bits[i]) < _extent[i])
+                        ++l_bits[i];
+                }
+                for (int b = 0; b < 32; ++b)
+                    for (int i = 0; i < N_RANK; ++i)
+                        if (b < l_bits[i])
+                            l_pos[i][b] = l_next++;
+                for (int i = 0; i < N_RANK; ++i) {
+                    for (int x = 0; x < _extent[i]; ++x) {
+                        l_map[x] = 0;
+                        for (int b = 0; b < l_bits[i]; ++b)
+                            l_map[x] |= (I)((x >> b) & 1) << l_pos[i][b];
+                    }
+                    map_[i] = l_map + halo_[i];
+                    l_map += _extent[i];
+                }
+            }
+            mapped_ = true;
+        }
+
+        /* take over the storage order of 'orig', map_block_ is already released */
+        void copy_map(Pochoir_Array<T, N_RANK, I, B> const & orig) {
+            order_ = orig.order_; mapped_ = orig.mapped_;
+            map_size_ = orig.map_size_;
+            for (int i = 0; i < N_RANK; ++i) {
+                tile_[i] = orig.tile_[i];
+                map_[i] = NULL;
+            }
+            if (orig.map_block_ == NULL)
+                return;
+            map_block_ = new I[map_size_];
+            for (int k = 0; k < map_size_; ++k)
+                map_block_[k] = orig.map_block_[k];
+            for (int i = 0; i < N_RANK; ++i)
+                map_[i] = map_block_ + (orig.map_[i] - orig.map_block_);
+        }
+
+        /* offset of the point _idx within a time slot */
+        inline I index_of(int const * _idx) const {
+            if (!pochoir_mapped(mapped_))
+                return cal_index<N_RANK-1>(_idx, stride_);
+            I l_idx = 0;
+            for (int i = 0; i < N_RANK; ++i)
+                l_idx += map_[i][_idx[i]];
+            return l_idx;
+        }
+
+        /* refresh the halo cells standing for the points of 'region'
+         * (within the array) just computed by the kernel at time t
+         */
+        void update_halo(int t, grid_info<N_RANK> const & region) {
+            if (B::constant)
+                return;
+            I l_base = ((t + shape_[0].shift[0]) & tmask_) * total_size_;
+            for (int i = 0; i < N_RANK; ++i) {
+                if (halo_[i] == 0)
+                    continue;
+                /* only the points within halo_[i] of a face have copies */
+                grid_info<N_RANK> l_slab = region;
+                l_slab.x1[i] = min(region.x1[i], halo_[i]);
+                copy_to_halo(l_base, l_slab);
+                l_slab = region;
+                l_slab.x0[i] = max(region.x0[i], phys_size_[i] - halo_[i]);
+                copy_to_halo(l_base, l_slab);
+            }
+        }
+
+        /* fill the halo cells of all time steps kept in memory */
+        void fill_halo(void) {
+            grid_info<N_RANK> l_all;
+            for (int i = 0; i < N_RANK; ++i) {
+                l_all.x0[i] = 0; l_all.x1[i] = phys_size_[i];
+                l_all.dx0[i] = l_all.dx1[i] = 0;
+            }
+            for (int t = 0; t <= tmask_; ++t) {
+                if (!B::constant) {
+                    update_halo(t - shape_[0].shift[0], l_all);
+                    continue;
+                }
+                I l_base = t * total_size_;
+                for (int i = 0; i < N_RANK; ++i) {
+                    /* the slabs of halo cells below and above dimension i */
+                    int l_lo[N_RANK], l_hi[N_RANK], l_idx[N_RANK];
+                    for (int j = 0; j < N_RANK; ++j) {
+                        l_lo[j] = -halo_[j]; l_hi[j] = phys_size_[j] + halo_[j];
+                    }
+                    for (int s = 0; s < 2; ++s) {
+                        l_lo[i] = (s == 0) ? -halo_[i] : phys_size_[i];
+                        l_hi[i] = (s == 0) ? 0 : phys_size_[i] + halo_[i];
+                        if (l_lo[i] >= l_hi[i])
+                            continue;
+                        for (int j = 0; j < N_RANK; ++j)
+                            l_idx[j] = l_lo[j];
+                        do {
+                            element(l_base + index_of(l_idx)) = bconst_;
+                        } while (next_index(l_idx, l_lo, l_hi));
+                    }
+                }
+            }
+        }
+
+        /* odometer over the box [lo, hi), false once it wraps around */
+        static inline bool next_index(int * idx, int const * lo, int const * hi) {
+            for (int i = 0; i < N_RANK; ++i) {
+                if (++idx[i] < hi[i])
+                    return true;
+                idx[i] = lo[i];
+            }
+            return false;
+        }
+
+        /* copy each point of 'box' to the halo cells the boundary maps
+         * onto it
+         */
+        void copy_to_halo(I base, grid_info<N_RANK> const & box) {
+            int l_idx[N_RANK], l_img[N_RANK], l_lo[N_RANK], l_hi[N_RANK];
+            /* the coordinates standing for l_idx[i] : itself and up to
+             * 2 * halo_[i] halo coordinates
+             */
+            int l_cand[N_RANK][2 * POCHOIR_HALO_MAX + 1], l_ncand[N_RANK];
+            for (int i = 0; i < N_RANK; ++i) {
+                if (box.x0[i] >= box.x1[i])
+                    return;
+                l_idx[i] = box.x0[i];
+            }
+            do {
+                bool l_has_copy = false;
+                for (int i = 0; i < N_RANK; ++i) {
+                    l_cand[i][0] = l_idx[i];
+                    l_ncand[i] = 1;
+                    for (int h = 1; h <= halo_[i]; ++h) {
+                        if (B::remap(-h, 0, phys_size_[i]) == l_idx[i])
+                            l_cand[i][l_ncand[i]++] = -h;
+                        if (B::remap(phys_size_[i] - 1 + h, 0, phys_size_[i]) == l_idx[i])
+                            l_cand[i][l_ncand[i]++] = phys_size_[i] - 1 + h;
+                    }
+                    l_has_copy = l_has_copy || (l_ncand[i] > 1);
+                    l_lo[i] = 0; l_hi[i] = l_ncand[i];
+                }
+                if (!l_has_copy)
+                    continue;
+                T const l_value = element(base + index_of(l_idx));
+                int l_pick[N_RANK];
+                for (int i = 0; i < N_RANK; ++i)
+                    l_pick[i] = 0;
+                /* all combinations but the point itself (all picks 0) */
+                while (next_index(l_pick, l_lo, l_hi)) {
+                    for (int i = 0; i < N_RANK; ++i)
+                        l_img[i] = l_cand[i][l_pick[i]];
+                    element(base + index_of(l_img)) = l_value;
+                }
+            } while (next_index(l_idx, box.x0, box.x1));
+        }
 		/* return size */
 		int phys_size(int _dim) const { return phys_size_[_dim]; }
 		int logic_size(int _dim) const { return logic_size_[_dim]; }
         /* the size() function is for user's convenience! */
 		int size(int _dim) const { return phys_size_[_dim]; }
 		int slope(int _dim) const { return slope_[_dim]; }
+        /* number of time steps kept in memory */
+		int toggle() const { return toggle_; }
+        /* number of time slots allocated, toggle() rounded up to a power of two */
+		int slots() const { int l_slots = 1; while (l_slots < toggle_) l_slots <<= 1; return l_slots; }
+        /* slot_mask() == slots() - 1, time step t is stored in slot (t & slot_mask()) */
+		int slot_mask() const { return tmask_; }
 
 		/* return total_size_ */
-		int total_size() const { return total_size_; }
+		I total_size() const { return total_size_; }
 
 		/* return stride */
-		int stride (int _dim) const { return stride_[_dim]; }
+		I stride (int _dim) const { return stride_[_dim]; }
 
         inline bool check_boundary(size_info const & _idx) const {
             bool touch_boundary = false;
@@ -649,7 +1643,7 @@ class Pochoir_Array {
                  || _idx3 < logic_start_[3] || _idx3 >= logic_end_[3] \
                  || _idx4 < logic_start_[4] || _idx4 >= logic_end_[4] \
                  || _idx5 < logic_start_[5] || _idx5 >= logic_end_[5] \
-                 || _idx6 < logic_start_[6] || _idx5 >= logic_end_[6])
+                 || _idx6 < logic_start_[6] || _idx6 >= logic_end_[6])
 
 #define check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0) \
             (_idx0 < logic_start_[0] || _idx0 >= logic_end_[0] \
@@ -658,8 +1652,8 @@ class Pochoir_Array {
                  || _idx3 < logic_start_[3] || _idx3 >= logic_end_[3] \
                  || _idx4 < logic_start_[4] || _idx4 >= logic_end_[4] \
                  || _idx5 < logic_start_[5] || _idx5 >= logic_end_[5] \
-                 || _idx6 < logic_start_[6] || _idx5 >= logic_end_[6] \
-                 || _idx7 < logic_start_[7] || _idx5 >= logic_end_[7])
+                 || _idx6 < logic_start_[6] || _idx6 >= logic_end_[6] \
+                 || _idx7 < logic_start_[7] || _idx7 >= logic_end_[7])
         /* 
          * orig_value() is reserved for "ostream" : cout << Pochoir_Array
          */
@@ -667,7 +1661,16 @@ class Pochoir_Array {
             bool l_boundary = check_boundary(_idx);
             bool set_boundary = false;
             T l_bvalue = 0;
-            if (l_boundary && bv1_ != NULL) {
+            if (l_boundary && B::constant) {
+                l_bvalue = bconst_;
+                set_boundary = true;
+            } else if (l_boundary && B::builtin) {
+                size_info l_idx;
+                for (int i = 0; i < N_RANK; ++i)
+                    l_idx[i] = B::remap(_idx[i], logic_start_[i], logic_end_[i]);
+                l_bvalue = element(index_of(l_idx) + (_timestep & tmask_) * total_size_);
+                set_boundary = true;
+            } else if (l_boundary && bv1_ != NULL) {
                 l_bvalue = bv1_(*this, _timestep, _idx[0]);
                 set_boundary = true;
             } else if (l_boundary && bv2_ != NULL) {
@@ -694,8 +1697,8 @@ class Pochoir_Array {
             }
 
             /* the highest dimension is time dimension! */
-            int l_idx = cal_index<N_RANK>(_idx, stride_) + (_timestep % toggle_) * total_size_;
-            return (set_boundary) ? l_bvalue : (*view_)[l_idx];
+            I l_idx = index_of(_idx) + (_timestep & tmask_) * total_size_;
+            return (set_boundary) ? l_bvalue : T(element(l_idx));
         }
 
 		/* index operator() for the format of a(i, j, k) 
@@ -703,18 +1706,18 @@ class Pochoir_Array {
          * - this is the uninterior version
          */
 
-		inline T & operator() (int _idx1, int _idx0) {
+		inline reference operator() (int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx1 - home_cell_[0];
-                l_shift[1] = _idx0 - home_cell_[1];
+                l_shift[0] = _idx1 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx0 - pochoir_shape_check_.home_cell[1];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -725,28 +1728,32 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary1(_idx1, _idx0);
-            bool set_boundary = (l_boundary && bv1_ != NULL);
-            if (set_boundary) { 
-                ret_v() = bv1_(*this, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary1(_idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                } else if (bv1_ != NULL) {
+                    ret_v() = bv1_(*this, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] : _idx0 * stride_[0]) + (_idx1 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx2 - home_cell_[0];
-                l_shift[1] = _idx1 - home_cell_[1]; l_shift[2] = _idx0 - home_cell_[2];
+                l_shift[0] = _idx2 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx1 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx0 - pochoir_shape_check_.home_cell[2];
                 bool l_within_shape = check_shape(l_shift);
                 // printf("branch called!\n");
                 /* very weird!!! This branch is never called in optimized run,
@@ -763,29 +1770,34 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary2(_idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv2_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary2(_idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                } else if (bv2_ != NULL) {
+                    ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] : _idx0 * stride_[0] + _idx1 * stride_[1]) + (_idx2 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx3 - home_cell_[0];
-                l_shift[1] = _idx2 - home_cell_[1]; l_shift[2] = _idx1 - home_cell_[2];
-                l_shift[3] = _idx0 - home_cell_[3];
+                l_shift[0] = _idx3 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx2 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx1 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx0 - pochoir_shape_check_.home_cell[3];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -797,29 +1809,35 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary3(_idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv3_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary3(_idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                } else if (bv3_ != NULL) {
+                    ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2]) + (_idx3 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx4 - home_cell_[0];
-                l_shift[1] = _idx3 - home_cell_[1]; l_shift[2] = _idx2 - home_cell_[2];
-                l_shift[3] = _idx1 - home_cell_[3]; l_shift[4] = _idx0 - home_cell_[4];
+                l_shift[0] = _idx4 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx3 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx2 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx1 - pochoir_shape_check_.home_cell[3]; l_shift[4] = _idx0 - pochoir_shape_check_.home_cell[4];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -831,30 +1849,37 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv4_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                } else if (bv4_ != NULL) {
+                    ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3]) + (_idx4 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx5 - home_cell_[0];
-                l_shift[1] = _idx4 - home_cell_[1]; l_shift[2] = _idx3 - home_cell_[2];
-                l_shift[3] = _idx2 - home_cell_[3]; l_shift[4] = _idx1 - home_cell_[4];
-                l_shift[5] = _idx0 - home_cell_[5];
+                l_shift[0] = _idx5 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx4 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx3 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx2 - pochoir_shape_check_.home_cell[3]; l_shift[4] = _idx1 - pochoir_shape_check_.home_cell[4];
+                l_shift[5] = _idx0 - pochoir_shape_check_.home_cell[5];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -866,30 +1891,38 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv5_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                } else if (bv5_ != NULL) {
+                    ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4]) + (_idx5 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx6 - home_cell_[0];
-                l_shift[1] = _idx5 - home_cell_[1]; l_shift[2] = _idx4 - home_cell_[2];
-                l_shift[3] = _idx3 - home_cell_[3]; l_shift[4] = _idx2 - home_cell_[4];
-                l_shift[5] = _idx1 - home_cell_[5]; l_shift[6] = _idx0 - home_cell_[6];
+                l_shift[0] = _idx6 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx5 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx4 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx3 - pochoir_shape_check_.home_cell[3]; l_shift[4] = _idx2 - pochoir_shape_check_.home_cell[4];
+                l_shift[5] = _idx1 - pochoir_shape_check_.home_cell[5]; l_shift[6] = _idx0 - pochoir_shape_check_.home_cell[6];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -901,31 +1934,40 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv6_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                } else if (bv6_ != NULL) {
+                    ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5]) + (_idx6 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx7 - home_cell_[0];
-                l_shift[1] = _idx6 - home_cell_[1]; l_shift[2] = _idx5 - home_cell_[2];
-                l_shift[3] = _idx4 - home_cell_[3]; l_shift[4] = _idx3 - home_cell_[4];
-                l_shift[5] = _idx2 - home_cell_[5]; l_shift[6] = _idx1 - home_cell_[6];
-                l_shift[7] = _idx0 - home_cell_[7];
+                l_shift[0] = _idx7 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx6 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx5 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx4 - pochoir_shape_check_.home_cell[3]; l_shift[4] = _idx3 - pochoir_shape_check_.home_cell[4];
+                l_shift[5] = _idx2 - pochoir_shape_check_.home_cell[5]; l_shift[6] = _idx1 - pochoir_shape_check_.home_cell[6];
+                l_shift[7] = _idx0 - pochoir_shape_check_.home_cell[7];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -937,31 +1979,41 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv7_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                    _idx6 = B::remap(_idx6, logic_start_[6], logic_end_[6]);
+                } else if (bv7_ != NULL) {
+                    ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6]) + (_idx7 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & operator() (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
+		inline reference operator() (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
             if (!allocMemFlag_) {
                 printf("Pochoir array access error:\n");
                 printf("A Pochoir array is accessed without being registered with a Pochoir object.\n");
                 exit(1);
             }
 #ifdef CHECK_SHAPE
-            if (inRun) {
+            if (pochoir_shape_check_.in_run) {
                 int l_shift[N_RANK+1];
                 int const l_home_time_cord = shape_[0].shift[0];
-                l_shift[0] = _idx8 - home_cell_[0];
-                l_shift[1] = _idx7 - home_cell_[1]; l_shift[2] = _idx6 - home_cell_[2];
-                l_shift[3] = _idx5 - home_cell_[3]; l_shift[4] = _idx4 - home_cell_[4];
-                l_shift[5] = _idx3 - home_cell_[5]; l_shift[6] = _idx2 - home_cell_[6];
-                l_shift[7] = _idx1 - home_cell_[7]; l_shift[8] = _idx0 - home_cell_[8];
+                l_shift[0] = _idx8 - pochoir_shape_check_.home_cell[0];
+                l_shift[1] = _idx7 - pochoir_shape_check_.home_cell[1]; l_shift[2] = _idx6 - pochoir_shape_check_.home_cell[2];
+                l_shift[3] = _idx5 - pochoir_shape_check_.home_cell[3]; l_shift[4] = _idx4 - pochoir_shape_check_.home_cell[4];
+                l_shift[5] = _idx3 - pochoir_shape_check_.home_cell[5]; l_shift[6] = _idx2 - pochoir_shape_check_.home_cell[6];
+                l_shift[7] = _idx1 - pochoir_shape_check_.home_cell[7]; l_shift[8] = _idx0 - pochoir_shape_check_.home_cell[8];
                 bool l_within_shape = check_shape(l_shift);
                 if (!l_within_shape) {
                     printf("Pochoir off-shape access error:\n");
@@ -973,55 +2025,66 @@ class Pochoir_Array {
                 }
             }
 #endif
-            bool l_boundary = check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv8_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
-            }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+            if (check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                    _idx6 = B::remap(_idx6, logic_start_[6], logic_end_[6]);
+                    _idx7 = B::remap(_idx7, logic_start_[7], logic_end_[7]);
+                } else if (bv8_ != NULL) {
+                    ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
+            }
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] + map_[7][_idx7] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7]) + (_idx8 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
         /* set()/get() pair to set/get boundary value in user supplied bvalue function */
-		inline T & set (int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] : _idx0 * stride_[0]) + (_idx1 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] : _idx0 * stride_[0] + _idx1 * stride_[1]) + (_idx2 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2]) + (_idx3 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3]) + (_idx4 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4]) + (_idx5 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5]) + (_idx6 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6]) + (_idx7 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & set (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference set (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] + map_[7][_idx7] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7]) + (_idx8 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
 		inline T get (int _idx1, int _idx0) {
@@ -1030,8 +2093,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d)\n", _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] : _idx0 * stride_[0]) + (_idx1 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx2, int _idx1, int _idx0) {
@@ -1040,8 +2103,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d)\n", _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] : _idx0 * stride_[0] + _idx1 * stride_[1]) + (_idx2 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1050,8 +2113,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d)\n", _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2]) + (_idx3 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1060,8 +2123,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d)\n", _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3]) + (_idx4 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1070,8 +2133,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d)\n", _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4]) + (_idx5 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1080,8 +2143,8 @@ class Pochoir_Array {
                 printf("Out-of-range accesss by boundary function at index (%d, %d, %d, %d, %d, %d, %d)\n", _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5]) + (_idx6 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1090,8 +2153,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d)\n", _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6]) + (_idx7 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		inline T get (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
@@ -1100,8 +2163,8 @@ class Pochoir_Array {
                 printf("Out-of-range access by boundary function at index (%d, %d, %d, %d, %d, %d, %d, %d, %d)\n", _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
                 exit(1);
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] + map_[7][_idx7] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7]) + (_idx8 & tmask_) * total_size_;
+			return element(l_idx);
 		}
 
 		/* index operator() for the format of a.interior(i, j, k) 
@@ -1109,132 +2172,192 @@ class Pochoir_Array {
          * - this is the interior (non-checking) version
          */
 
-		inline T & interior (int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] : _idx0 * stride_[0]) + (_idx1 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] : _idx0 * stride_[0] + _idx1 * stride_[1]) + (_idx2 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2]) + (_idx3 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3]) + (_idx4 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4]) + (_idx5 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5]) + (_idx6 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6]) + (_idx7 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & interior (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-			return (*view_)[l_idx];
+		inline reference interior (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] + map_[7][_idx7] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7]) + (_idx8 & tmask_) * total_size_;
+			return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx1, int _idx0) {
-            bool l_boundary = check_boundary1(_idx1, _idx0);
-            bool set_boundary = (l_boundary && bv1_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv1_(*this, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary1(_idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                } else if (bv1_ != NULL) {
+                    ret_v() = bv1_(*this, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + (_idx1 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] : _idx0 * stride_[0]) + (_idx1 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary2(_idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv2_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary2(_idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                } else if (bv2_ != NULL) {
+                    ret_v() = bv2_(*this, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + (_idx2 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] : _idx0 * stride_[0] + _idx1 * stride_[1]) + (_idx2 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary3(_idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv3_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary3(_idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                } else if (bv3_ != NULL) {
+                    ret_v() = bv3_(*this, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + (_idx3 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2]) + (_idx3 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv4_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary4(_idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                } else if (bv4_ != NULL) {
+                    ret_v() = bv4_(*this, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + (_idx4 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3]) + (_idx4 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv5_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary5(_idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                } else if (bv5_ != NULL) {
+                    ret_v() = bv5_(*this, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + (_idx5 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4]) + (_idx5 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv6_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary6(_idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                } else if (bv6_ != NULL) {
+                    ret_v() = bv6_(*this, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + (_idx6 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5]) + (_idx6 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv7_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary7(_idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                    _idx6 = B::remap(_idx6, logic_start_[6], logic_end_[6]);
+                } else if (bv7_ != NULL) {
+                    ret_v() = bv7_(*this, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + (_idx7 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6]) + (_idx7 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
-		inline T & boundary (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0) {
-            bool l_boundary = check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-            bool set_boundary = (l_boundary && bv8_ != NULL);
-            if (set_boundary) {
-                ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
-                return ret_v();
+		inline reference boundary (int _idx8, int _idx7, int _idx6, int _idx5, int _idx4, int _idx3, int _idx2, int _idx1, int _idx0, scratch && _ref = scratch()) {
+            if (check_boundary8(_idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0)) {
+                if (B::constant)
+                    return value_ref(bconst_, _ref);
+                if (B::builtin) {
+                    _idx0 = B::remap(_idx0, logic_start_[0], logic_end_[0]);
+                    _idx1 = B::remap(_idx1, logic_start_[1], logic_end_[1]);
+                    _idx2 = B::remap(_idx2, logic_start_[2], logic_end_[2]);
+                    _idx3 = B::remap(_idx3, logic_start_[3], logic_end_[3]);
+                    _idx4 = B::remap(_idx4, logic_start_[4], logic_end_[4]);
+                    _idx5 = B::remap(_idx5, logic_start_[5], logic_end_[5]);
+                    _idx6 = B::remap(_idx6, logic_start_[6], logic_end_[6]);
+                    _idx7 = B::remap(_idx7, logic_start_[7], logic_end_[7]);
+                } else if (bv8_ != NULL) {
+                    ret_v() = bv8_(*this, _idx8, _idx7, _idx6, _idx5, _idx4, _idx3, _idx2, _idx1, _idx0);
+                    return value_ref(ret_v(), _ref);
+                }
             }
-			int l_idx = _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7] + (_idx8 % toggle_) * total_size_;
-            return (*(data_ + l_idx));
+			I l_idx = (pochoir_mapped(mapped_) ? map_[0][_idx0] + map_[1][_idx1] + map_[2][_idx2] + map_[3][_idx3] + map_[4][_idx4] + map_[5][_idx5] + map_[6][_idx6] + map_[7][_idx7] : _idx0 * stride_[0] + _idx1 * stride_[1] + _idx2 * stride_[2] + _idx3 * stride_[3] + _idx4 * stride_[4] + _idx5 * stride_[5] + _idx6 * stride_[6] + _idx7 * stride_[7]) + (_idx8 & tmask_) * total_size_;
+            return element(l_idx, _ref);
 		}
 
 		/* size_info is of type int[] */
@@ -1258,14 +2381,14 @@ class Pochoir_Array {
 		}
 
 #if 1
-		template <typename T2, int N2>
-		friend std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x); 
+		template <typename T2, int N2, typename I2, typename B2>
+		friend std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2, I2, B2> const & x); 
 #endif
 };
 
 #if 1
-template<typename T2, int N2>
-std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x) { 
+template<typename T2, int N2, typename I2, typename B2>
+std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2, I2, B2> const & x) { 
 	typedef int size_info[N2];
 	size_info l_index, l_head_index, l_tail_index;
 	bool done = false, line_break = false;
@@ -1282,10 +2405,10 @@ std::ostream& operator<<(std::ostream& os, Pochoir_Array<T2, N2> const & x) {
 
 	while (!done) {
 		T2 x0, x1;
-		x0 = const_cast<Pochoir_Array<T2, N2> &>(x).orig_value(0, l_index);
-		x1 = const_cast<Pochoir_Array<T2, N2> &>(x).orig_value(1, l_index);
+		x0 = const_cast<Pochoir_Array<T2, N2, I2, B2> &>(x).orig_value(0, l_index);
+		x1 = const_cast<Pochoir_Array<T2, N2, I2, B2> &>(x).orig_value(1, l_index);
 		os << std::setw(9) << x0 << " (" << x1 << ")" << " "; 
-		done = const_cast<Pochoir_Array<T2, N2> &>(x).update_index(l_index, line_break, l_head_index, l_tail_index);
+		done = const_cast<Pochoir_Array<T2, N2, I2, B2> &>(x).update_index(l_index, line_break, l_head_index, l_tail_index);
 		if (line_break) {
 			os << std::endl;
 			line_break = false;
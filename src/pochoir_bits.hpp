@@ -0,0 +1,234 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Bit-packed boolean arrays, see Pochoir_Bit_Array_ND. The cells of a
+ * cellular automaton take one bit each instead of a bool, 64 to a word,
+ * and the rows of a time slot start on a word. A kernel written for an
+ * array of bool works unchanged on them, one cell at a time, while
+ * Pochoir_Bit_Life_Kernel computes the base zoids of a Life-like
+ * automaton a whole word of cells at once.
+ */
+#ifndef POCHOIR_BITS_HPP
+#define POCHOIR_BITS_HPP
+
+#include "pochoir_common.hpp"
+#include "pochoir_proxy.hpp"
+
+typedef unsigned long long pochoir_word;
+
+/* a cell of a bit-packed array, bit 'bit' of the word at 'word'. The
+ * zoids next to each other along the unit-stride dimension run in
+ * parallel and share the words at their edges, so the cell is read and
+ * written with atomic operations on its own bit only.
+ */
+class Pochoir_Bit_Ref
+{
+public:
+    Pochoir_Bit_Ref(pochoir_word * _word, int _bit) : word_(_word), mask_((pochoir_word)1 << _bit) { }
+    operator bool() const {
+        return (__atomic_load_n(word_, __ATOMIC_RELAXED) & mask_) != 0;
+    }
+    Pochoir_Bit_Ref & operator= (bool _b) {
+        if (_b)
+            __atomic_fetch_or(word_, mask_, __ATOMIC_RELAXED);
+        else
+            __atomic_fetch_and(word_, ~mask_, __ATOMIC_RELAXED);
+        return *this;
+    }
+    Pochoir_Bit_Ref & operator= (Pochoir_Bit_Ref const & _r) {
+        return (*this = (bool)_r);
+    }
+private:
+    pochoir_word * word_;
+    pochoir_word mask_;
+};
+
+/* a cell as a single value (the boundary values, ...) : bit 0 of a word,
+ * so that it is addressed like the cells of the array
+ */
+struct pochoir_bit {
+    pochoir_word bits_;
+
+    pochoir_bit() = default;
+    pochoir_bit(bool _b) : bits_(_b ? 1 : 0) { }
+    pochoir_bit(Pochoir_Bit_Ref const & _r) : bits_((bool)_r ? 1 : 0) { }
+    operator bool() const { return (bits_ & 1) != 0; }
+};
+
+/* the element at index idx is bit (idx % 64) of word (idx / 64); bytes(n)
+ * is exact for the multiples of 64, which the offsets of the rows and of
+ * the time slots are
+ */
+template <>
+struct Pochoir_Layout<pochoir_bit, false> {
+    typedef Pochoir_Bit_Ref reference;
+    typedef Pochoir_No_Ref scratch;
+    enum { soa = 0, bits = 1, word = sizeof(pochoir_word) };
+    static inline reference ref(char * _base, long _idx, long, scratch &) { return Pochoir_Bit_Ref((pochoir_word *)_base + (_idx >> 6), (int)(_idx & 63)); }
+    static inline long field(long _off, long) { return _off; }
+    static inline long bytes(long _n) { return size(_n) * word; }
+    static inline long size(long _n) { return (_n + 63) >> 6; }
+};
+
+/* Life-like automaton on a 2D bit-packed array A, for the shape of the 8
+ * neighbours and the cell itself at t-1 : a dead cell with n live
+ * neighbours is born if bit n of 'birth' is set, a live one survives if
+ * bit n of 'survive' is set; the defaults B3/S23 are the Game of Life.
+ * It is both the obase kernel of the interior zoids, computed by words,
+ * and the boundary kernel, cell by cell through the boundary of the array :
+ *     life.Run_Obase(T, kernel, kernel)
+ */
+template <typename A>
+struct Pochoir_Bit_Life_Kernel {
+    A & a_;
+    unsigned birth_, survive_;
+    /* the counts n that change the state of a cell : flip_[k] holds the
+     * complements of the bits of the k-th of them, so that the count
+     * s3 s2 s1 s0 of a cell is that n where all of s_b ^ flip_[k][b] are
+     * set, and it is born / survives where born_[k] / survive_[k] is
+     */
+    int num_counts_;
+    pochoir_word flip_[9][4], born_[9], survives_[9];
+
+    Pochoir_Bit_Life_Kernel(A & _a, unsigned _birth = 1u << 3, unsigned _survive = (1u << 2) | (1u << 3)) : a_(_a), birth_(_birth), survive_(_survive) {
+        static_assert(A::layout::bits, "Pochoir_Bit_Life_Kernel needs a bit-packed array");
+        num_counts_ = 0;
+        for (int n = 0; n <= 8; ++n) {
+            if (((_birth | _survive) >> n & 1) == 0)
+                continue;
+            for (int b = 0; b < 4; ++b)
+                flip_[num_counts_][b] = ((n >> b) & 1) ? 0 : ~(pochoir_word)0;
+            born_[num_counts_] = ((_birth >> n) & 1) ? ~(pochoir_word)0 : 0;
+            survives_[num_counts_] = ((_survive >> n) & 1) ? ~(pochoir_word)0 : 0;
+            ++num_counts_;
+        }
+    }
+
+    static inline void full_add(pochoir_word _a, pochoir_word _b, pochoir_word _c, pochoir_word & _sum, pochoir_word & _carry) {
+        const pochoir_word l_ab = _a ^ _b;
+        _sum = l_ab ^ _c;
+        _carry = (_a & _b) | (l_ab & _c);
+    }
+
+    static inline pochoir_word load(pochoir_word const * _w) {
+        return __atomic_load_n(_w, __ATOMIC_RELAXED);
+    }
+
+    /* the next state of the 64 cells of _mid[1], from the words before
+     * and after it (_mid[0], _mid[2]) and the same words of the rows above
+     * and below : the 8 neighbours of every cell are summed bit-sliced
+     * into the count s3 s2 s1 s0, one bit of each per cell
+     */
+    inline pochoir_word next(pochoir_word const _up[3], pochoir_word const _mid[3], pochoir_word const _down[3]) const {
+        /* cell j is bit j % 64, its west neighbour j-1 is the word shifted up */
+        const pochoir_word l_uw = (_up[1] << 1) | (_up[0] >> 63), l_ue = (_up[1] >> 1) | (_up[2] << 63);
+        const pochoir_word l_mw = (_mid[1] << 1) | (_mid[0] >> 63), l_me = (_mid[1] >> 1) | (_mid[2] << 63);
+        const pochoir_word l_dw = (_down[1] << 1) | (_down[0] >> 63), l_de = (_down[1] >> 1) | (_down[2] << 63);
+        pochoir_word l_a0, l_a1, l_b0, l_b1, l_d0, l_d1, l_c0, l_u0, l_u1, l_v1;
+        pochoir_word l_s[4];
+        full_add(l_uw, _up[1], l_ue, l_a0, l_a1);
+        full_add(l_mw, l_me, l_dw, l_b0, l_b1);
+        l_d0 = _down[1] ^ l_de; l_d1 = _down[1] & l_de;
+        /* weight 1 */
+        full_add(l_a0, l_b0, l_d0, l_s[0], l_c0);
+        /* weight 2 : a1, b1, d1 and the carry c0 */
+        full_add(l_a1, l_b1, l_d1, l_u0, l_u1);
+        l_s[1] = l_u0 ^ l_c0; l_v1 = l_u0 & l_c0;
+        /* weight 4 and 8 */
+        l_s[2] = l_u1 ^ l_v1; l_s[3] = l_u1 & l_v1;
+        const pochoir_word l_alive = _mid[1];
+        pochoir_word l_next = 0;
+        for (int k = 0; k < num_counts_; ++k) {
+            const pochoir_word l_count = (l_s[0] ^ flip_[k][0]) & (l_s[1] ^ flip_[k][1]) & (l_s[2] ^ flip_[k][2]) & (l_s[3] ^ flip_[k][3]);
+            l_next |= l_count & ((born_[k] & ~l_alive) | (survives_[k] & l_alive));
+        }
+        return l_next;
+    }
+
+    /* cells [_j0, _j1) of the row _out of _words words, from the rows
+     * _in[0..2] above, at and below it in the previous time step
+     */
+    inline void row(pochoir_word * _out, pochoir_word const * const _in[3], long _words, int _j0, int _j1) const {
+        const long l_w0 = _j0 >> 6, l_w1 = (_j1 - 1) >> 6;
+        /* l_win[r] holds the words w-1, w and w+1 of row r */
+        pochoir_word l_win[3][3];
+        for (int r = 0; r < 3; ++r) {
+            l_win[r][1] = (l_w0 > 0) ? load(_in[r] + l_w0 - 1) : 0;
+            l_win[r][2] = load(_in[r] + l_w0);
+        }
+        for (long w = l_w0; w <= l_w1; ++w) {
+            for (int r = 0; r < 3; ++r) {
+                l_win[r][0] = l_win[r][1];
+                l_win[r][1] = l_win[r][2];
+                l_win[r][2] = (w + 1 < _words) ? load(_in[r] + w + 1) : 0;
+            }
+            const pochoir_word l_next = next(l_win[0], l_win[1], l_win[2]);
+            pochoir_word l_keep = ~(pochoir_word)0;
+            if (w == l_w0)
+                l_keep &= ~(pochoir_word)0 << (_j0 & 63);
+            if (w == l_w1)
+                l_keep &= ~(pochoir_word)0 >> (63 - ((_j1 - 1) & 63));
+            if (l_keep == ~(pochoir_word)0) {
+                __atomic_store_n(_out + w, l_next, __ATOMIC_RELAXED);
+            } else {
+                /* the rest of the word belongs to the zoid next door */
+                pochoir_word l_old = load(_out + w);
+                while (!__atomic_compare_exchange_n(_out + w, &l_old, (l_old & ~l_keep) | (l_next & l_keep), true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    ;
+            }
+        }
+    }
+
+    /* obase kernel of the interior zoids */
+    inline void operator() (int t0, int t1, grid_info<2> const & grid) const {
+        pochoir_word * l_base = (pochoir_word *)a_.bytes();
+        const long l_words = (long)a_.stride(1) >> 6, l_slot = (long)a_.total_size() >> 6;
+        const int l_mask = a_.slot_mask();
+        grid_info<2> l_grid = grid;
+        for (int t = t0; t < t1; ++t) {
+            pochoir_word * l_out = l_base + (t & l_mask) * l_slot;
+            pochoir_word const * l_prev = l_base + ((t - 1) & l_mask) * l_slot;
+            for (int i = l_grid.x0[1]; i < l_grid.x1[1]; ++i) {
+                pochoir_word const * const l_in[3] = { l_prev + (i - 1) * l_words, l_prev + i * l_words, l_prev + (i + 1) * l_words };
+                if (l_grid.x0[0] < l_grid.x1[0])
+                    row(l_out + i * l_words, l_in, l_words, l_grid.x0[0], l_grid.x1[0]);
+            }
+            for (int r = 0; r < 2; ++r) {
+                l_grid.x0[r] += l_grid.dx0[r]; l_grid.x1[r] += l_grid.dx1[r];
+            }
+        }
+    }
+
+    /* boundary kernel, one cell */
+    inline void operator() (int t, int i, int j) const {
+        const int l_n = a_(t-1, i-1, j-1) + a_(t-1, i-1, j) + a_(t-1, i-1, j+1) +
+                        a_(t-1, i, j-1) + a_(t-1, i, j+1) +
+                        a_(t-1, i+1, j-1) + a_(t-1, i+1, j) + a_(t-1, i+1, j+1);
+        const bool l_alive = a_(t-1, i, j);
+        a_(t, i, j) = (((l_alive ? survive_ : birth_) >> l_n) & 1) != 0;
+    }
+};
+
+#endif /* POCHOIR_BITS_HPP */
@@ -32,11 +32,27 @@
 #include <cstdlib>
 #include <string>
 
-#if 0
+#include "pochoir_parallel.hpp"
+
+/* serial elision of the Cilk keywords, so that user code written against
+ * Cilk Plus (e.g. the verification loops in examples/) still compiles
+ * with the native or serial backends
+ */
+#if POCHOIR_BACKEND != POCHOIR_BACKEND_CILK
+#ifndef cilk_spawn
 #define cilk_spawn 
+#endif
+#ifndef cilk_sync
 #define cilk_sync
+#endif
+#ifndef cilk_for
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_OPENMP
+#define cilk_for _Pragma("omp parallel for") for
+#else
 #define cilk_for for
 #endif
+#endif
+#endif
 
 static inline double tdiff (struct timeval *a, struct timeval *b)
 {
@@ -50,6 +66,93 @@ static inline int StrToInt(const std::string& s)
 
 #define ARRAY_LENGTH(x) (int)(sizeof(x)/sizeof(x[0]))
 
+/* data cache capacity per core in bytes, read once from
+ * /sys/devices/system/cpu/cpu0/cache. A cache shared by several cpus
+ * is divided evenly among them. The L2 capacity can be overridden with
+ * the environment variable POCHOIR_L2_SIZE (in bytes, K/M suffix allowed).
+ */
+struct Pochoir_Cache_Info {
+    long l1, l2, llc;
+};
+
+static inline long pochoir_parse_size(const char * str) {
+    char * l_end;
+    long l_size = strtol(str, &l_end, 10);
+    if (*l_end == 'K' || *l_end == 'k')
+        l_size <<= 10;
+    else if (*l_end == 'M' || *l_end == 'm')
+        l_size <<= 20;
+    else if (*l_end == 'G' || *l_end == 'g')
+        l_size <<= 30;
+    return l_size;
+}
+
+/* # of cpus in a sysfs cpu list such as "0-3,8-11" */
+static inline int pochoir_count_cpus(const char * str) {
+    int l_count = 0;
+    while (*str != '\0' && *str != '\n') {
+        char * l_end;
+        long l_lo = strtol(str, &l_end, 10), l_hi = l_lo;
+        if (l_end == str)
+            break;
+        if (*l_end == '-')
+            l_hi = strtol(l_end + 1, &l_end, 10);
+        l_count += (int)(l_hi - l_lo + 1);
+        str = (*l_end == ',') ? l_end + 1 : l_end;
+    }
+    return (l_count > 0) ? l_count : 1;
+}
+
+static inline bool pochoir_read_line(const char * path, char * buf, int len) {
+    FILE * fp = fopen(path, "r");
+    if (fp == NULL)
+        return false;
+    bool l_ok = (fgets(buf, len, fp) != NULL);
+    fclose(fp);
+    return l_ok;
+}
+
+static inline Pochoir_Cache_Info pochoir_detect_cache() {
+    /* fallback if sysfs is not available */
+    Pochoir_Cache_Info l_info = { 32L << 10, 256L << 10, 2L << 20 };
+    for (int idx = 0; idx < 8; ++idx) {
+        char l_path[128], l_buf[256];
+        snprintf(l_path, sizeof(l_path), "/sys/devices/system/cpu/cpu0/cache/index%d/type", idx);
+        if (!pochoir_read_line(l_path, l_buf, sizeof(l_buf)))
+            break;
+        if (l_buf[0] == 'I') /* Instruction */
+            continue;
+        snprintf(l_path, sizeof(l_path), "/sys/devices/system/cpu/cpu0/cache/index%d/level", idx);
+        if (!pochoir_read_line(l_path, l_buf, sizeof(l_buf)))
+            continue;
+        int l_level = atoi(l_buf);
+        snprintf(l_path, sizeof(l_path), "/sys/devices/system/cpu/cpu0/cache/index%d/size", idx);
+        if (!pochoir_read_line(l_path, l_buf, sizeof(l_buf)))
+            continue;
+        long l_size = pochoir_parse_size(l_buf);
+        snprintf(l_path, sizeof(l_path), "/sys/devices/system/cpu/cpu0/cache/index%d/shared_cpu_list", idx);
+        if (pochoir_read_line(l_path, l_buf, sizeof(l_buf)))
+            l_size /= pochoir_count_cpus(l_buf);
+        if (l_size <= 0)
+            continue;
+        if (l_level == 1)
+            l_info.l1 = l_size;
+        else if (l_level == 2)
+            l_info.l2 = l_size;
+        else
+            l_info.llc = l_size;
+    }
+    const char * l_env = getenv("POCHOIR_L2_SIZE");
+    if (l_env != NULL && pochoir_parse_size(l_env) > 0)
+        l_info.l2 = pochoir_parse_size(l_env);
+    return l_info;
+}
+
+static inline Pochoir_Cache_Info const & pochoir_cache_info() {
+    static const Pochoir_Cache_Info l_info = pochoir_detect_cache();
+    return l_info;
+}
+
 /* due to the fact that bit trick is much slower than conditional instruction,
  * let's disable it for now!!!
  */
@@ -101,12 +204,111 @@ struct Pochoir_Shape {
 template <int N_RANK, size_t N>
 size_t ArraySize (Pochoir_Shape<N_RANK> (& arr)[N]) { return N; }
 
-#define KLEIN 0
-#define USE_CILK_FOR 0
-#define BICUT 1
 #define STAT 0
-static bool inRun = false;
-static int home_cell_[9];
+
+/* Execution policy of a Pochoir::Run()/Run_Obase(), replaces the former
+ * compile-time switches BICUT, USE_CILK_FOR and KLEIN, so that different
+ * traversals can be benchmarked within one binary.
+ * - algor : which cache-oblivious walker to use. Run() with a plain
+ *           kernel only has two walkers : POCHOIR_ALGOR_NCORES selects
+ *           walk_ncores_boundary_p(), everything else walk_bicut_boundary_p().
+ *           For Run_Obase(), POCHOIR_ALGOR_NCORES selects the walkers of
+ *           the former BICUT=0 build, obase_m() for an obase kernel alone
+ *           and obase_boundary_p() with a boundary kernel
+ * - spawn : how the subzoids of one dependency level of a hyperspace cut
+ *           are forked, one pochoir_spawn() per subzoid or one
+ *           pochoir_parallel_for() over the whole level
+ * - topology : wrap-around of the boundary region, POCHOIR_TOPOLOGY_KLEIN
+ *           (Klein bottle) is only defined for 2D stencils
+ * - dim_topology[] : per dimension (indexed like dx_thres[]), whether the
+ *           domain wraps around in that dimension. Only periodic and
+ *           twisted dimensions take the initial cut that merges the zoids
+ *           at both faces; open dimensions are cut like an interior
+ *           region, so that no zoid straddles their faces, and the
+ *           boundary kernel (or a built-in boundary of the arrays, e.g.
+ *           Pochoir_Boundary_Mirror for a reflecting wall) handles the
+ *           reads beyond them. Twisted
+ *           is POCHOIR_TOPOLOGY_KLEIN and only defined for dimension 0
+ *           of 2D stencils
+ * - dt_thres / dx_thres[] : coarsening of the base case in the interior
+ *           region, 0 keeps the built-in default of Algorithm::set_thres()
+ *           or the entry recorded by Pochoir::Tune() in the tuning file
+ * - use_tune_db : whether zero thresholds are looked up in the tuning file
+ *           (see pochoir_tune.hpp) before falling back to the defaults
+ * - cache_plan : record the zoid decomposition on the first run and replay
+ *           it on later runs with the same grid, timestep and policy
+ *           (see pochoir_plan.hpp)
+ */
+typedef enum {
+    POCHOIR_ALGOR_SHORTER_DUO_SIM = 0,
+    POCHOIR_ALGOR_DUO_SIM,
+    POCHOIR_ALGOR_SIM,
+    POCHOIR_ALGOR_STEVENJ,
+    POCHOIR_ALGOR_BICUT,
+    POCHOIR_ALGOR_NCORES
+} Pochoir_Algor_Type;
+
+typedef enum {
+    POCHOIR_SPAWN_RECURSIVE = 0,
+    POCHOIR_SPAWN_PARALLEL_FOR
+} Pochoir_Spawn_Type;
+
+typedef enum {
+    POCHOIR_TOPOLOGY_TORUS = 0,
+    POCHOIR_TOPOLOGY_KLEIN
+} Pochoir_Topology_Type;
+
+typedef enum {
+    POCHOIR_DIM_PERIODIC = 0,
+    POCHOIR_DIM_OPEN,
+    POCHOIR_DIM_TWISTED
+} Pochoir_Dim_Topology_Type;
+
+struct Pochoir_Policy {
+    Pochoir_Algor_Type algor;
+    Pochoir_Spawn_Type spawn;
+    Pochoir_Topology_Type topology;
+    int dt_thres;
+    int dx_thres[SUPPORT_RANK];
+    Pochoir_Dim_Topology_Type dim_topology[SUPPORT_RANK];
+    bool use_tune_db;
+    bool cache_plan;
+
+    Pochoir_Policy(Pochoir_Algor_Type _algor = POCHOIR_ALGOR_SHORTER_DUO_SIM,
+                   Pochoir_Spawn_Type _spawn = POCHOIR_SPAWN_RECURSIVE,
+                   Pochoir_Topology_Type _topology = POCHOIR_TOPOLOGY_TORUS) 
+        : algor(_algor), spawn(_spawn), topology(_topology), dt_thres(0), use_tune_db(true), cache_plan(false) {
+        for (int i = 0; i < SUPPORT_RANK; ++i) {
+            dx_thres[i] = 0;
+            dim_topology[i] = POCHOIR_DIM_PERIODIC;
+        }
+    }
+};
+
+static inline const char * algor_name(Pochoir_Algor_Type _algor) {
+    switch (_algor) {
+        case POCHOIR_ALGOR_SHORTER_DUO_SIM: return "shorter_duo_sim";
+        case POCHOIR_ALGOR_DUO_SIM: return "duo_sim";
+        case POCHOIR_ALGOR_SIM: return "sim";
+        case POCHOIR_ALGOR_STEVENJ: return "stevenj";
+        case POCHOIR_ALGOR_BICUT: return "bicut";
+        case POCHOIR_ALGOR_NCORES: return "ncores";
+    }
+    return "unknown";
+}
+
+#ifdef CHECK_SHAPE
+/* shape-checking context of the calling thread: whether a checked Run()
+ * is in progress and the home cell {t, i, j, ...} being computed. It is
+ * per thread, so concurrent runs of several Pochoir objects do not mix
+ * up their home cells, and it does not exist outside CHECK_SHAPE builds.
+ */
+struct Pochoir_Shape_Check {
+    bool in_run;
+    int home_cell[9];
+};
+static thread_local Pochoir_Shape_Check pochoir_shape_check_ = { false, { 0 } };
+#endif
 
 static inline void klein(int & new_i, int & new_j, grid_info<2> const & grid) {
     int l_arr_size_1 = grid.x1[1] - grid.x0[1];
@@ -126,6 +328,14 @@ static inline void klein(int & new_i, int & new_j, grid_info<2> const & grid) {
     return;
 }
 
+/* the Klein bottle is only defined for 2D, Pochoir::Run() rejects
+ * POCHOIR_TOPOLOGY_KLEIN for other ranks
+ */
+template <int N_RANK>
+static inline void klein_region(grid_info<N_RANK> & grid, grid_info<N_RANK> const & initial_grid) {
+    return;
+}
+
 static inline void klein_region(grid_info<2> & grid, grid_info<2> const & initial_grid) {
     grid_info<2> orig_grid;
     const int l_arr_size_1 = initial_grid.x1[1] - initial_grid.x0[1];
@@ -175,6 +385,57 @@ static inline void klein_region(grid_info<2> & grid, grid_info<2> const & initia
 #define Pochoir_Array_7D(type) Pochoir_Array<type, 7>
 #define Pochoir_Array_8D(type) Pochoir_Array<type, 8>
 
+/* the index type of the arrays, see Pochoir_Array::index_type : int by
+ * default, -DPOCHOIR_INDEX_TYPE=long for all arrays, or the _Large_ arrays
+ * below for the ones whose time slots hold more than 2^31 elements
+ */
+#ifndef POCHOIR_INDEX_TYPE
+#define POCHOIR_INDEX_TYPE int
+#endif
+
+#define Pochoir_Array_Large_1D(type) Pochoir_Array<type, 1, long>
+#define Pochoir_Array_Large_2D(type) Pochoir_Array<type, 2, long>
+#define Pochoir_Array_Large_3D(type) Pochoir_Array<type, 3, long>
+#define Pochoir_Array_Large_4D(type) Pochoir_Array<type, 4, long>
+#define Pochoir_Array_Large_5D(type) Pochoir_Array<type, 5, long>
+#define Pochoir_Array_Large_6D(type) Pochoir_Array<type, 6, long>
+#define Pochoir_Array_Large_7D(type) Pochoir_Array<type, 7, long>
+#define Pochoir_Array_Large_8D(type) Pochoir_Array<type, 8, long>
+
+/* arrays with a built-in boundary, e.g. Pochoir_Boundary_Periodic, see
+ * Pochoir_Boundary_Fn below
+ */
+#define Pochoir_Boundary_Array_1D(type, boundary) Pochoir_Array<type, 1, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_2D(type, boundary) Pochoir_Array<type, 2, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_3D(type, boundary) Pochoir_Array<type, 3, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_4D(type, boundary) Pochoir_Array<type, 4, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_5D(type, boundary) Pochoir_Array<type, 5, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_6D(type, boundary) Pochoir_Array<type, 6, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_7D(type, boundary) Pochoir_Array<type, 7, POCHOIR_INDEX_TYPE, boundary>
+#define Pochoir_Boundary_Array_8D(type, boundary) Pochoir_Array<type, 8, POCHOIR_INDEX_TYPE, boundary>
+
+/* arrays whose elements are stored as 'storage' (e.g. float, pochoir_half,
+ * pochoir_bfloat16) and computed on as 'compute', see pochoir_stored.hpp
+ */
+#define Pochoir_Stored_Array_1D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 1>
+#define Pochoir_Stored_Array_2D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 2>
+#define Pochoir_Stored_Array_3D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 3>
+#define Pochoir_Stored_Array_4D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 4>
+#define Pochoir_Stored_Array_5D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 5>
+#define Pochoir_Stored_Array_6D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 6>
+#define Pochoir_Stored_Array_7D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 7>
+#define Pochoir_Stored_Array_8D(compute, storage) Pochoir_Array<Pochoir_Stored<compute, storage>, 8>
+
+/* arrays of booleans packed 64 to a word, see pochoir_bits.hpp */
+#define Pochoir_Bit_Array_1D Pochoir_Array<pochoir_bit, 1>
+#define Pochoir_Bit_Array_2D Pochoir_Array<pochoir_bit, 2>
+#define Pochoir_Bit_Array_3D Pochoir_Array<pochoir_bit, 3>
+#define Pochoir_Bit_Array_4D Pochoir_Array<pochoir_bit, 4>
+#define Pochoir_Bit_Array_5D Pochoir_Array<pochoir_bit, 5>
+#define Pochoir_Bit_Array_6D Pochoir_Array<pochoir_bit, 6>
+#define Pochoir_Bit_Array_7D Pochoir_Array<pochoir_bit, 7>
+#define Pochoir_Bit_Array_8D Pochoir_Array<pochoir_bit, 8>
+
 #define Pochoir_Shape_1D Pochoir_Shape<1>
 #define Pochoir_Shape_2D Pochoir_Shape<2>
 #define Pochoir_Shape_3D Pochoir_Shape<3>
@@ -244,37 +505,127 @@ static inline void klein_region(grid_info<2> & grid, grid_info<2> const & initia
  *   so we have to return a value of T&
  */
 #define Pochoir_Boundary_1D(name, arr, t, i) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 1> & arr, int t, int i) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 1, T_Index> & arr, int t, int i) { 
 
 #define Pochoir_Boundary_2D(name, arr, t, i, j) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 2> & arr, int t, int i, int j) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 2, T_Index> & arr, int t, int i, int j) { 
 
 #define Pochoir_Boundary_3D(name, arr, t, i, j, k) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 3> & arr, int t, int i, int j, int k) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 3, T_Index> & arr, int t, int i, int j, int k) { 
 
 #define Pochoir_Boundary_4D(name, arr, t, i, j, k, l) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 4> & arr, int t, int i, int j, int k, int l) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 4, T_Index> & arr, int t, int i, int j, int k, int l) { 
 
 #define Pochoir_Boundary_5D(name, arr, t, i, j, k, l, m) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 5> & arr, int t, int i, int j, int k, int l, int m) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 5, T_Index> & arr, int t, int i, int j, int k, int l, int m) { 
 
 #define Pochoir_Boundary_6D(name, arr, t, i, j, k, l, m, n) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 6> & arr, int t, int i, int j, int k, int l, int m, int n) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 6, T_Index> & arr, int t, int i, int j, int k, int l, int m, int n) { 
 
 #define Pochoir_Boundary_7D(name, arr, t, i, j, k, l, m, n, o) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 7> & arr, int t, int i, int j, int k, int l, int m, int n, int o) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 7, T_Index> & arr, int t, int i, int j, int k, int l, int m, int n, int o) { 
 
 #define Pochoir_Boundary_8D(name, arr, t, i, j, k, l, m, n, o, p) \
-    template <typename T> \
-    T name (Pochoir_Array<T, 8> & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p) { 
+    template <typename T, typename T_Index> \
+    T name (Pochoir_Array<T, 8, T_Index> & arr, int t, int i, int j, int k, int l, int m, int n, int o, int p) { 
 
 #define Pochoir_Boundary_End }
 
+/* built-in boundary conditions : the boundary policy of an array is its
+ * fourth template argument (see Pochoir_Boundary_Array_ND), so that the
+ * accessors fold an out-of-range index back into the domain (or return
+ * the constant) inline, resolved at compile time, instead of calling the
+ * boundary function through a pointer, e.g.
+ *     Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Periodic) a(N, N);
+ *     Pochoir_Boundary_Array_2D(double, Pochoir_Boundary_Constant) b(N, N);
+ *     b.Register_Boundary(pochoir_boundary_constant(1.0));
+ * - builtin : whether the accessors use remap() instead of the registered
+ *           boundary function
+ * - constant : whether the points outside of the domain hold the constant
+ *           of the array (T() unless registered) instead
+ * - remap(i, lb, ub) : an index outside [lb, ub) mapped back into it
+ */
+struct Pochoir_Boundary_Fn {
+    enum { builtin = 0, constant = 0 };
+    static inline int remap(int i, int lb, int ub) { return i; }
+};
+
+/* wrap around */
+struct Pochoir_Boundary_Periodic {
+    enum { builtin = 1, constant = 0 };
+    /* out of line, so that the accessors stay small enough to be inlined
+     * into the kernels
+     */
+    static inline int remap(int i, int lb, int ub) {
+        return (i >= lb && i < ub) ? i : wrap(i, lb, ub);
+    }
+    static __attribute__((noinline)) int wrap(int i, int lb, int ub) {
+        const int l_size = ub - lb;
+        /* one period off the domain at most for any stencil shorter than
+         * the grid
+         */
+        if (i < lb && i >= lb - l_size)
+            return i + l_size;
+        if (i >= ub && i < ub + l_size)
+            return i - l_size;
+        i = (i - lb) % l_size;
+        return lb + (i < 0 ? i + l_size : i);
+    }
+};
+
+/* the nearest point of the domain */
+struct Pochoir_Boundary_Clamp {
+    enum { builtin = 1, constant = 0 };
+    static inline int remap(int i, int lb, int ub) {
+        return (i < lb) ? lb : (i >= ub ? ub - 1 : i);
+    }
+};
+
+/* reflect at the domain face : -1 -> 0, n -> n-1 */
+struct Pochoir_Boundary_Mirror {
+    enum { builtin = 1, constant = 0 };
+    static inline int remap(int i, int lb, int ub) {
+        return (i >= lb && i < ub) ? i : reflect(i, lb, ub);
+    }
+    static __attribute__((noinline)) int reflect(int i, int lb, int ub) {
+        const int l_size = ub - lb;
+        if (i < lb && i >= lb - l_size)
+            return 2 * lb - 1 - i;
+        if (i >= ub && i < ub + l_size)
+            return 2 * ub - 1 - i;
+        i = (i - lb) % (2 * l_size);
+        if (i < 0)
+            i += 2 * l_size;
+        return lb + (i < l_size ? i : 2 * l_size - 1 - i);
+    }
+};
+
+/* zero, or the value registered with pochoir_boundary_constant() */
+struct Pochoir_Boundary_Zero {
+    enum { builtin = 1, constant = 1 };
+    static inline int remap(int i, int lb, int ub) { return i; }
+};
+struct Pochoir_Boundary_Constant {
+    enum { builtin = 1, constant = 1 };
+    static inline int remap(int i, int lb, int ub) { return i; }
+};
+
+template <typename T>
+struct Pochoir_Boundary_Value {
+    T value;
+    explicit Pochoir_Boundary_Value(T const & v) : value(v) { }
+};
+
+template <typename T>
+inline Pochoir_Boundary_Value<T> pochoir_boundary_constant(T const & v) {
+    return Pochoir_Boundary_Value<T>(v);
+}
+
 #endif /* POCHOIR_COMMON_H */
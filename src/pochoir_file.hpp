@@ -0,0 +1,77 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* File-backed storage, see Pochoir_Array::Register_File().
+ * The storage of such an array is a shared mapping of a file, which may
+ * be larger than the physical memory. The trapezoidal walk keeps the
+ * accesses local, and before each base zoid runs, the pages it is going
+ * to touch in the file-backed arrays are asked for with MADV_WILLNEED,
+ * so that they are read in ahead instead of faulted in one at a time.
+ */
+#ifndef POCHOIR_FILE_HPP
+#define POCHOIR_FILE_HPP
+
+#include "pochoir_common.hpp"
+
+/* a file-backed array, type-erased for the Pochoir object */
+template <int N_RANK>
+struct Pochoir_File_Array {
+    void * arr_;
+    void (*advise_)(void *, int, int, grid_info<N_RANK> const &);
+
+    template <typename A>
+    static void advise(void * arr, int t0, int t1, grid_info<N_RANK> const & grid) {
+        static_cast<A *>(arr)->advise(t0, t1, grid);
+    }
+    template <typename A>
+    void set(A & arr) {
+        arr_ = (void *)&arr;
+        advise_ = &advise<A>;
+    }
+};
+
+/* a kernel whose base zoids first hint their footprint in the
+ * file-backed arrays, a no-op without any
+ */
+template <int N_RANK, typename F>
+struct Pochoir_Advise_Kernel {
+    F const & f_;
+    Pochoir_File_Array<N_RANK> const * arrs_;
+    int num_arrs_;
+    Pochoir_Advise_Kernel(F const & _f, Pochoir_File_Array<N_RANK> const * _arrs, int _num_arrs) : f_(_f), arrs_(_arrs), num_arrs_(_num_arrs) {}
+
+    inline void advise(int t0, int t1, grid_info<N_RANK> const & grid) const {
+        for (int j = 0; j < num_arrs_; ++j)
+            arrs_[j].advise_(arrs_[j].arr_, t0, t1, grid);
+    }
+
+    /* obase kernels */
+    inline void operator() (int t0, int t1, grid_info<N_RANK> const & grid) const {
+        advise(t0, t1, grid);
+        f_(t0, t1, grid);
+    }
+};
+
+#endif /* POCHOIR_FILE_HPP */
@@ -0,0 +1,136 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Halo storage, see Pochoir_Array::Register_Halo().
+ * Run_Obase(T, f) on arrays with halos walks the whole domain as a torus
+ * and hands every base zoid to 'f'. Zoids which stay clear of the halo
+ * sources (the points within the halo width of a face) are passed on 
+ * unchanged. The others are run one time step at a time, split where 
+ * they wrap around the domain, and after each step the halo cells 
+ * standing for the points just computed are refreshed, so that they are
+ * up to date before any dependent point reads them.
+ */
+#ifndef POCHOIR_HALO_HPP
+#define POCHOIR_HALO_HPP
+
+#include "pochoir_common.hpp"
+
+/* an array with halos, type-erased for the Pochoir object */
+template <int N_RANK>
+struct Pochoir_Halo_Array {
+    void * arr_;
+    void (*update_)(void *, int, grid_info<N_RANK> const &);
+    void (*fill_)(void *);
+
+    template <typename A>
+    static void update(void * arr, int t, grid_info<N_RANK> const & region) {
+        static_cast<A *>(arr)->update_halo(t, region);
+    }
+    template <typename A>
+    static void fill(void * arr) { static_cast<A *>(arr)->fill_halo(); }
+    template <typename A>
+    void set(A & arr) {
+        arr_ = (void *)&arr;
+        update_ = &update<A>;
+        fill_ = &fill<A>;
+    }
+};
+
+template <int N_RANK, typename F>
+struct Pochoir_Halo_Kernel {
+    F const & f_;
+    grid_info<N_RANK> const & phys_grid_;
+    int const * halo_;
+    Pochoir_Halo_Array<N_RANK> const * arrs_;
+    int num_arrs_;
+    Pochoir_Halo_Kernel(F const & _f, grid_info<N_RANK> const & _phys_grid, int const * _halo, Pochoir_Halo_Array<N_RANK> const * _arrs, int _num_arrs) : f_(_f), phys_grid_(_phys_grid), halo_(_halo), arrs_(_arrs), num_arrs_(_num_arrs) {}
+
+    inline void operator() (int t0, int t1, grid_info<N_RANK> const & grid) const {
+        const int lt = t1 - t0;
+        bool l_inner = true;
+        for (int i = 0; i < N_RANK; ++i) {
+            l_inner = l_inner 
+                && min(grid.x0[i], grid.x0[i] + grid.dx0[i] * lt) >= phys_grid_.x0[i] + halo_[i]
+                && max(grid.x1[i], grid.x1[i] + grid.dx1[i] * lt) <= phys_grid_.x1[i] - halo_[i];
+        }
+        if (l_inner) {
+            f_(t0, t1, grid);
+            return;
+        }
+        grid_info<N_RANK> l_grid = grid;
+        for (int t = t0; t < t1; ++t) {
+            single_step(t, l_grid);
+            for (int i = 0; i < N_RANK; ++i) {
+                l_grid.x0[i] += l_grid.dx0[i]; l_grid.x1[i] += l_grid.dx1[i];
+            }
+        }
+    }
+
+    /* one time step of a zoid no wider than the domain, which wraps 
+     * around each dimension at most once
+     */
+    inline void single_step(int t, grid_info<N_RANK> const & grid) const {
+        int l_x0[N_RANK][2], l_x1[N_RANK][2], l_nseg[N_RANK], l_seg[N_RANK];
+        for (int i = 0; i < N_RANK; ++i) {
+            const int l_lo = phys_grid_.x0[i], l_size = phys_grid_.x1[i] - phys_grid_.x0[i];
+            l_nseg[i] = 0;
+            l_seg[i] = 0;
+            for (int x = grid.x0[i]; x < grid.x1[i]; ) {
+                /* shift x back by a multiple of the size into the domain */
+                const int l_off = x - l_lo;
+                const int l_shift = l_size * (l_off >= 0 ? l_off / l_size : -((l_size - 1 - l_off) / l_size));
+                assert(l_nseg[i] < 2);
+                l_x0[i][l_nseg[i]] = x - l_shift;
+                l_x1[i][l_nseg[i]] = min(grid.x1[i] - l_shift, phys_grid_.x1[i]);
+                x = l_x1[i][l_nseg[i]] + l_shift;
+                ++l_nseg[i];
+            }
+            if (l_nseg[i] == 0)
+                return;
+        }
+        grid_info<N_RANK> l_piece;
+        do {
+            for (int i = 0; i < N_RANK; ++i) {
+                l_piece.x0[i] = l_x0[i][l_seg[i]];
+                l_piece.x1[i] = l_x1[i][l_seg[i]];
+                l_piece.dx0[i] = l_piece.dx1[i] = 0;
+            }
+            f_(t, t+1, l_piece);
+            for (int j = 0; j < num_arrs_; ++j)
+                arrs_[j].update_(arrs_[j].arr_, t, l_piece);
+        } while (next_seg(l_seg, l_nseg));
+    }
+
+    static inline bool next_seg(int * seg, int const * nseg) {
+        for (int i = 0; i < N_RANK; ++i) {
+            if (++seg[i] < nseg[i])
+                return true;
+            seg[i] = 0;
+        }
+        return false;
+    }
+};
+
+#endif /* POCHOIR_HALO_HPP */
@@ -0,0 +1,979 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Parallel backend of the Pochoir runtime.
+ * The walkers only use the following primitives:
+ * - Pochoir_Task_Group / pochoir_spawn() / pochoir_sync() : fork-join
+ * - pochoir_spawn_near() : pochoir_spawn() of a task whose data lies at
+ *   position pos of [0, len) along the outermost dimension, see below
+ * - pochoir_numa_groups() : # of worker groups of the NUMA mode
+ * - pochoir_parallel_for() : parallel loop over [begin, end)
+ * - pochoir_parallel_region() : entry point of a walker, sets up the
+ *   worker team if the backend needs one
+ * - pochoir_get_nworkers() / pochoir_set_nworkers() / pochoir_worker_id()
+ * - Pochoir_Holder<T> : per-worker scratch storage
+ * - Pochoir_Reducer_Opadd<T> : per-worker sum reducer
+ * - Pochoir_Reducer<T, OP> : per-worker reducer over Pochoir_Reduce_Sum/
+ *   Pochoir_Reduce_Max/Pochoir_Reduce_Min
+ * - pochoir_begin_record() / pochoir_end_record() : serial recording of
+ *   the series-parallel structure of a walk, see Pochoir_Stage_Join
+ * - pochoir_steal_stats() / pochoir_reset_steal_stats() : work-stealing
+ *   counters of the native backend
+ * The backend is selected at compile time by POCHOIR_BACKEND :
+ * - POCHOIR_BACKEND_NATIVE (default) : std::thread work-stealing scheduler
+ * - POCHOIR_BACKEND_CILK : Intel Cilk Plus (-fcilkplus -lcilkrts)
+ * - POCHOIR_BACKEND_OPENMP : OpenMP tasks (-fopenmp), honours
+ *   OMP_NUM_THREADS / OMP_PLACES / OMP_PROC_BIND of the host application
+ * - POCHOIR_BACKEND_SERIAL : everything runs on the calling thread
+ * Spawned tasks may run after the spawning function has moved on,
+ * so anything a task needs from the parent's frame must be captured
+ * by value (or outlive the matching pochoir_sync()).
+ */
+#ifndef POCHOIR_PARALLEL_HPP
+#define POCHOIR_PARALLEL_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#define POCHOIR_BACKEND_SERIAL 0
+#define POCHOIR_BACKEND_NATIVE 1
+#define POCHOIR_BACKEND_CILK 2
+#define POCHOIR_BACKEND_OPENMP 3
+
+#ifndef POCHOIR_BACKEND
+#define POCHOIR_BACKEND POCHOIR_BACKEND_NATIVE
+#endif
+
+/* padding unit for per-worker slots, avoids false sharing among workers */
+#define POCHOIR_CACHE_LINE 64
+
+/* arrays of per-worker objects, padded by hand to whole cache lines, start
+ * on a cache line : plain new only honours an alignas() beyond that of
+ * max_align_t from C++17 on
+ */
+template <typename T>
+static inline T * pochoir_aligned_new(int _n) {
+    void * l_mem = NULL;
+    if (posix_memalign(&l_mem, POCHOIR_CACHE_LINE, (_n > 0 ? _n : 1) * sizeof(T)) != 0) {
+        printf("Pochoir error: out of memory for %d per-worker objects!\n", _n);
+        exit(1);
+    }
+    T * l_arr = (T *)l_mem;
+    for (int i = 0; i < _n; ++i)
+        new (l_arr + i) T();
+    return l_arr;
+}
+
+template <typename T>
+static inline void pochoir_aligned_delete(T * _arr, int _n) {
+    for (int i = 0; i < _n; ++i)
+        _arr[i].~T();
+    free(_arr);
+}
+
+/* work-stealing counters, summed over all workers. Only the native
+ * backend counts, the others always report zeros.
+ * - placed : tasks a worker took from the inbox of its own group, i.e.
+ *   spawned near the data of that group by a worker of another group
+ * - local_steals : tasks stolen from a worker of the same group
+ * - remote_steals : tasks stolen from a worker or inbox of another group
+ */
+struct Pochoir_Steal_Stats {
+    long placed, local_steals, remote_steals;
+};
+
+/* associative operators of Pochoir_Reducer<T, OP> */
+template <typename T>
+struct Pochoir_Reduce_Sum {
+    static inline T identity() { return T(0); }
+    static inline T apply(T const & a, T const & b) { return a + b; }
+};
+
+template <typename T>
+struct Pochoir_Reduce_Max {
+    static inline T identity() { return std::numeric_limits<T>::lowest(); }
+    static inline T apply(T const & a, T const & b) { return (a < b) ? b : a; }
+};
+
+template <typename T>
+struct Pochoir_Reduce_Min {
+    static inline T identity() { return std::numeric_limits<T>::max(); }
+    static inline T apply(T const & a, T const & b) { return (b < a) ? b : a; }
+};
+
+/* While a thread records (see pochoir_plan.hpp), pochoir_spawn() and
+ * pochoir_parallel_for() run every child inline on the recording thread
+ * and only keep track of the stage at which the next leaf of the walk
+ * could start : a leaf takes the current stage and moves it on by one,
+ * spawned children all start at the stage of their spawn, and a sync
+ * moves on to the latest stage reached by any child of the group.
+ * Leaves sharing a stage have no series-parallel path between them.
+ */
+struct Pochoir_Stage_Clock {
+    bool recording_;
+    int cur_;
+};
+
+static inline Pochoir_Stage_Clock & pochoir_stage_clock() {
+    static thread_local Pochoir_Stage_Clock l_clock = { false, 0 };
+    return l_clock;
+}
+
+static inline bool pochoir_recording() { return pochoir_stage_clock().recording_; }
+
+static inline void pochoir_begin_record() {
+    pochoir_stage_clock().recording_ = true;
+    pochoir_stage_clock().cur_ = 0;
+}
+
+static inline void pochoir_end_record() { pochoir_stage_clock().recording_ = false; }
+
+/* stage of the next leaf */
+static inline int pochoir_record_leaf() { return pochoir_stage_clock().cur_++; }
+
+/* part of every Pochoir_Task_Group, the destructor is the implicit sync */
+struct Pochoir_Stage_Join {
+    int end_;
+    Pochoir_Stage_Join() : end_(0) {}
+    ~Pochoir_Stage_Join() { join(); }
+
+    template <typename Fn>
+    inline void fork(Fn const & fn) {
+        Pochoir_Stage_Clock & l_clock = pochoir_stage_clock();
+        int const l_start = l_clock.cur_;
+        fn();
+        if (l_clock.cur_ > end_)
+            end_ = l_clock.cur_;
+        l_clock.cur_ = l_start;
+    }
+
+    inline void join() {
+        Pochoir_Stage_Clock & l_clock = pochoir_stage_clock();
+        if (l_clock.recording_ && l_clock.cur_ < end_)
+            l_clock.cur_ = end_;
+        end_ = 0;
+    }
+};
+
+template <typename Body>
+static inline void pochoir_record_parallel_for(int _begin, int _end, Body const & body)
+{
+    Pochoir_Stage_Join l_join;
+    for (int i = _begin; i < _end; ++i) {
+        l_join.fork([&]{ body(i); });
+    }
+    l_join.join();
+}
+
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_CILK
+/* ************************************************************************
+ * Cilk Plus backend
+ * ************************************************************************/
+#include <cilk/cilk.h>
+#include <cilk/cilk_api.h>
+#include <cilk/holder.h>
+#include <cilk/reducer_opadd.h>
+#include <cilk/reducer.h>
+#include <new>
+
+/* Cilk has an implicit sync at the end of every function,
+ * so the task group carries nothing but the recording state.
+ * cilk_sync must stay in the frame of the spawning function,
+ * hence macros instead of member functions
+ */
+struct Pochoir_Task_Group {
+    Pochoir_Stage_Join join_;
+};
+
+#define pochoir_spawn(_tg, ...) \
+do { \
+    if (pochoir_recording()) \
+        (_tg).join_.fork(__VA_ARGS__); \
+    else \
+        cilk_spawn (__VA_ARGS__)(); \
+} while (0)
+
+#define pochoir_sync(_tg) \
+do { \
+    if (pochoir_recording()) \
+        (_tg).join_.join(); \
+    else \
+        cilk_sync; \
+} while (0)
+
+#define pochoir_spawn_near(_tg, _pos, _len, ...) pochoir_spawn(_tg, __VA_ARGS__)
+
+template <typename Body>
+static inline void pochoir_parallel_for(int _begin, int _end, Body const & body)
+{
+    if (pochoir_recording()) {
+        pochoir_record_parallel_for(_begin, _end, body);
+        return;
+    }
+    cilk_for (int i = _begin; i < _end; ++i) {
+        body(i);
+    }
+}
+
+template <typename Body>
+static inline void pochoir_parallel_region(Body const & body) { body(); }
+
+static inline int pochoir_get_nworkers() { return __cilkrts_get_nworkers(); }
+static inline int pochoir_worker_id() { return __cilkrts_get_worker_number(); }
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    return (0 == __cilkrts_set_param("nworkers", nstr));
+}
+
+template <typename T>
+class Pochoir_Holder {
+    private:
+        cilk::holder<T, cilk::holder_keep_last> h_;
+    public:
+        inline T & operator() () { return h_(); }
+};
+
+template <typename T>
+class Pochoir_Reducer_Opadd {
+    private:
+        cilk::reducer_opadd<T> r_;
+    public:
+        inline Pochoir_Reducer_Opadd & operator++ () { ++r_; return *this; }
+        inline Pochoir_Reducer_Opadd & operator+= (T const & v) { r_ += v; return *this; }
+        inline T get_value() const { return r_.get_value(); }
+};
+
+template <typename T, typename OP>
+class Pochoir_Reducer {
+    private:
+        struct monoid : cilk::monoid_base<T> {
+            static void reduce(T * left, T * right) { *left = OP::apply(*left, *right); }
+            static void identity(T * p) { new (p) T(OP::identity()); }
+        };
+        cilk::reducer<monoid> r_;
+    public:
+        inline void reset() { r_.set_value(OP::identity()); }
+        inline void update(T const & v) { r_.view() = OP::apply(r_.view(), v); }
+        inline T get_value() const { return r_.get_value(); }
+};
+
+#else /* POCHOIR_BACKEND != POCHOIR_BACKEND_CILK */
+
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_NATIVE
+/* ************************************************************************
+ * Native backend : one deque per worker, the owner pushes/pops at the
+ * bottom (LIFO, depth-first like the serial elision) and thieves steal
+ * from the top (FIFO, the biggest subzoid of the victim).
+ * Worker 0 is whichever thread calls into the walker,
+ * workers 1 .. nworkers-1 are pool threads created on first spawn.
+ * NUMA mode (POCHOIR_NUMA=1 for one group per NUMA node, POCHOIR_NUMA=<k>
+ * for k groups) splits the workers into groups of consecutive ids, the
+ * same way Storage<T> splits the outermost dimension into slabs. Pool
+ * threads of a group are pinned to the cpus of its node if the groups
+ * match the nodes. pochoir_spawn_near() of a task that belongs to another
+ * group puts it into that group's inbox instead of the own deque, and a
+ * thief tries its own group before the others.
+ * ************************************************************************/
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <deque>
+#include <vector>
+#include <chrono>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+class Pochoir_Task_Group;
+
+struct Pochoir_Task {
+    Pochoir_Task_Group * tg_;
+    Pochoir_Task(Pochoir_Task_Group * _tg) : tg_(_tg) {}
+    virtual ~Pochoir_Task() {}
+    virtual void run() = 0;
+};
+
+template <typename Fn>
+struct Pochoir_Fn_Task : public Pochoir_Task {
+    Fn fn_;
+    Pochoir_Fn_Task(Pochoir_Task_Group * _tg, Fn const & _fn) : Pochoir_Task(_tg), fn_(_fn) {}
+    void run() { fn_(); }
+};
+
+static inline int & pochoir_tls_worker_id() {
+    static thread_local int l_id = 0;
+    return l_id;
+}
+
+class Pochoir_Scheduler {
+    private:
+        struct worker_deque {
+            std::mutex mtx_;
+            std::deque<Pochoir_Task *> dq_;
+            /* counted by the worker owning the deque */
+            std::atomic<long> placed_, local_steals_, remote_steals_;
+            char pad_[POCHOIR_CACHE_LINE];
+            worker_deque() : placed_(0), local_steals_(0), remote_steals_(0) {}
+        };
+        worker_deque * deques_;
+        /* one inbox per worker group, see push_near() */
+        worker_deque * inboxes_;
+        std::vector<std::thread> threads_;
+        int max_workers_, nworkers_;
+        /* requested # of worker groups, and the cpus of each NUMA node */
+        int numa_groups_;
+        std::vector<std::vector<int> > node_cpus_;
+        std::atomic<bool> started_;
+        std::mutex start_mtx_;
+        std::atomic<bool> stop_;
+        /* # of tasks sitting in the deques, and # of sleeping pool threads */
+        std::atomic<int> queued_, sleepers_;
+        std::mutex sleep_mtx_;
+        std::condition_variable sleep_cv_;
+
+        static int env_nworkers() {
+            const char * l_env = getenv("POCHOIR_NWORKERS");
+            if (l_env == NULL)
+                l_env = getenv("CILK_NWORKERS");
+            return (l_env == NULL) ? 0 : atoi(l_env);
+        }
+
+        /* cpus of node0, node1, ... as listed in /sys/devices/system/node */
+        static std::vector<std::vector<int> > detect_nodes() {
+            std::vector<std::vector<int> > l_nodes;
+            for (int n = 0; ; ++n) {
+                char l_path[128], l_buf[1024];
+                snprintf(l_path, sizeof(l_path), "/sys/devices/system/node/node%d/cpulist", n);
+                FILE * fp = fopen(l_path, "r");
+                if (fp == NULL)
+                    break;
+                bool l_ok = (fgets(l_buf, sizeof(l_buf), fp) != NULL);
+                fclose(fp);
+                std::vector<int> l_cpus;
+                for (const char * str = l_buf; l_ok && *str != '\0' && *str != '\n'; ) {
+                    char * l_end;
+                    long l_lo = strtol(str, &l_end, 10), l_hi = l_lo;
+                    if (l_end == str)
+                        break;
+                    if (*l_end == '-')
+                        l_hi = strtol(l_end + 1, &l_end, 10);
+                    for (long c = l_lo; c <= l_hi; ++c)
+                        l_cpus.push_back((int)c);
+                    str = (*l_end == ',') ? l_end + 1 : l_end;
+                }
+                l_nodes.push_back(l_cpus);
+            }
+            return l_nodes;
+        }
+
+
+        Pochoir_Scheduler() : threads_(), started_(false), stop_(false), queued_(0), sleepers_(0) {
+            int l_hw = (int)std::thread::hardware_concurrency();
+            int l_env = env_nworkers();
+            nworkers_ = (l_env > 0) ? l_env : (l_hw > 0 ? l_hw : 1);
+            max_workers_ = (nworkers_ > l_hw) ? nworkers_ : l_hw;
+            deques_ = pochoir_aligned_new<worker_deque>(max_workers_);
+            inboxes_ = pochoir_aligned_new<worker_deque>(max_workers_);
+            node_cpus_ = detect_nodes();
+            const char * l_numa = getenv("POCHOIR_NUMA");
+            numa_groups_ = (l_numa == NULL) ? 0 : atoi(l_numa);
+            if (numa_groups_ == 1)
+                numa_groups_ = (int)node_cpus_.size();
+            if (numa_groups_ < 1)
+                numa_groups_ = 1;
+        }
+
+        ~Pochoir_Scheduler() {
+            stop_threads();
+            pochoir_aligned_delete(deques_, max_workers_);
+            pochoir_aligned_delete(inboxes_, max_workers_);
+        }
+
+        void start_threads() {
+            std::lock_guard<std::mutex> l_lock(start_mtx_);
+            if (started_)
+                return;
+            stop_ = false;
+            for (int i = 1; i < nworkers_; ++i)
+                threads_.push_back(std::thread(&Pochoir_Scheduler::worker_loop, this, i));
+            started_ = true;
+        }
+
+        void stop_threads() {
+            std::lock_guard<std::mutex> l_lock(start_mtx_);
+            if (!started_)
+                return;
+            {
+                std::lock_guard<std::mutex> l_sleep_lock(sleep_mtx_);
+                stop_ = true;
+            }
+            sleep_cv_.notify_all();
+            for (size_t i = 0; i < threads_.size(); ++i)
+                threads_[i].join();
+            threads_.clear();
+            started_ = false;
+        }
+
+        void worker_loop(int _id) {
+            pochoir_tls_worker_id() = _id;
+#ifdef __linux__
+            if (ngroups() > 1 && ngroups() == (int)node_cpus_.size()) {
+                std::vector<int> const & l_cpus = node_cpus_[group_of(_id)];
+                cpu_set_t l_set;
+                CPU_ZERO(&l_set);
+                for (size_t c = 0; c < l_cpus.size(); ++c)
+                    CPU_SET(l_cpus[c], &l_set);
+                pthread_setaffinity_np(pthread_self(), sizeof(l_set), &l_set);
+            }
+#endif
+            while (!stop_.load()) {
+                if (run_one(_id))
+                    continue;
+                std::unique_lock<std::mutex> l_lock(sleep_mtx_);
+                ++sleepers_;
+                sleep_cv_.wait_for(l_lock, std::chrono::milliseconds(10),
+                        [this]{ return stop_.load() || queued_.load() > 0; });
+                --sleepers_;
+            }
+        }
+
+        inline Pochoir_Task * pop_bottom(int _id) {
+            worker_deque & l_dq = deques_[_id];
+            std::lock_guard<std::mutex> l_lock(l_dq.mtx_);
+            if (l_dq.dq_.empty())
+                return NULL;
+            Pochoir_Task * l_task = l_dq.dq_.back();
+            l_dq.dq_.pop_back();
+            --queued_;
+            return l_task;
+        }
+
+        inline Pochoir_Task * steal_top(worker_deque & l_dq) {
+            if (!l_dq.mtx_.try_lock())
+                return NULL;
+            Pochoir_Task * l_task = NULL;
+            if (!l_dq.dq_.empty()) {
+                l_task = l_dq.dq_.front();
+                l_dq.dq_.pop_front();
+                --queued_;
+            }
+            l_dq.mtx_.unlock();
+            return l_task;
+        }
+
+    public:
+        static Pochoir_Scheduler & instance() {
+            static Pochoir_Scheduler l_sched;
+            return l_sched;
+        }
+
+        inline int nworkers() const { return nworkers_; }
+        inline int max_workers() const { return max_workers_; }
+        inline int ngroups() const {
+            return (numa_groups_ < nworkers_) ? numa_groups_ : nworkers_;
+        }
+        inline int group_of(int _id) const { return _id * ngroups() / nworkers_; }
+
+        Pochoir_Steal_Stats steal_stats() const {
+            Pochoir_Steal_Stats l_stats = { 0, 0, 0 };
+            for (int i = 0; i < max_workers_; ++i) {
+                l_stats.placed += deques_[i].placed_.load(std::memory_order_relaxed);
+                l_stats.local_steals += deques_[i].local_steals_.load(std::memory_order_relaxed);
+                l_stats.remote_steals += deques_[i].remote_steals_.load(std::memory_order_relaxed);
+            }
+            return l_stats;
+        }
+
+        void reset_steal_stats() {
+            for (int i = 0; i < max_workers_; ++i) {
+                deques_[i].placed_ = 0;
+                deques_[i].local_steals_ = 0;
+                deques_[i].remote_steals_ = 0;
+            }
+        }
+
+        bool set_nworkers(int _n) {
+            if (_n < 1 || _n > max_workers_)
+                return false;
+            if (_n == nworkers_)
+                return true;
+            stop_threads();
+            nworkers_ = _n;
+            return true;
+        }
+
+        inline void push(Pochoir_Task * _task) {
+            if (!started_)
+                start_threads();
+            int l_id = pochoir_tls_worker_id();
+            {
+                worker_deque & l_dq = deques_[l_id];
+                std::lock_guard<std::mutex> l_lock(l_dq.mtx_);
+                l_dq.dq_.push_back(_task);
+                ++queued_;
+            }
+            if (sleepers_.load() > 0) {
+                std::lock_guard<std::mutex> l_lock(sleep_mtx_);
+                sleep_cv_.notify_one();
+            }
+        }
+
+        /* push a task that belongs to slab _pos of [0, _len) of the
+         * outermost dimension to the inbox of the group owning that slab,
+         * a negative _pos pushes it to our own deque
+         */
+        inline void push_near(Pochoir_Task * _task, int _pos, int _len) {
+            const int l_groups = ngroups();
+            if (l_groups == 1 || _pos < 0 || _len <= 0) {
+                push(_task);
+                return;
+            }
+            int l_group = (int)((long)_pos * l_groups / _len);
+            l_group = (l_group < 0) ? 0 : ((l_group >= l_groups) ? l_groups - 1 : l_group);
+            if (l_group == group_of(pochoir_tls_worker_id())) {
+                push(_task);
+                return;
+            }
+            if (!started_)
+                start_threads();
+            {
+                worker_deque & l_dq = inboxes_[l_group];
+                std::lock_guard<std::mutex> l_lock(l_dq.mtx_);
+                l_dq.dq_.push_back(_task);
+                ++queued_;
+            }
+            if (sleepers_.load() > 0) {
+                std::lock_guard<std::mutex> l_lock(sleep_mtx_);
+                sleep_cv_.notify_all();
+            }
+        }
+
+        /* run one task from our own deque or the inbox of our group, 
+         * or steal one, from our own group first;
+         * return false if there is nothing to do
+         */
+        inline Pochoir_Task * find_task(int _id);
+        inline bool run_one(int _id);
+};
+
+class Pochoir_Task_Group {
+    private:
+        std::atomic<int> pending_;
+        Pochoir_Stage_Join join_;
+        Pochoir_Task_Group(Pochoir_Task_Group const &);
+        Pochoir_Task_Group & operator= (Pochoir_Task_Group const &);
+    public:
+        Pochoir_Task_Group() : pending_(0) {}
+        /* implicit sync, same as the end of a Cilk function */
+        ~Pochoir_Task_Group() { sync(); }
+
+        template <typename Fn>
+        inline void spawn(Fn const & fn) {
+            if (pochoir_recording()) {
+                join_.fork(fn);
+                return;
+            }
+            Pochoir_Scheduler & l_sched = Pochoir_Scheduler::instance();
+            if (l_sched.nworkers() == 1) {
+                fn();
+                return;
+            }
+            ++pending_;
+            l_sched.push(new Pochoir_Fn_Task<Fn>(this, fn));
+        }
+
+        template <typename Fn>
+        inline void spawn_near(int _pos, int _len, Fn const & fn) {
+            if (pochoir_recording()) {
+                join_.fork(fn);
+                return;
+            }
+            Pochoir_Scheduler & l_sched = Pochoir_Scheduler::instance();
+            if (l_sched.nworkers() == 1) {
+                fn();
+                return;
+            }
+            ++pending_;
+            l_sched.push_near(new Pochoir_Fn_Task<Fn>(this, fn), _pos, _len);
+        }
+
+        inline void done() { --pending_; }
+
+        /* the waiting worker keeps executing tasks (its own first)
+         * until all children of this group have finished
+         */
+        inline void sync() {
+            join_.join();
+            if (pending_.load() == 0)
+                return;
+            Pochoir_Scheduler & l_sched = Pochoir_Scheduler::instance();
+            int const l_id = pochoir_tls_worker_id();
+            while (pending_.load() > 0) {
+                if (!l_sched.run_one(l_id))
+                    std::this_thread::yield();
+            }
+        }
+};
+
+inline Pochoir_Task * Pochoir_Scheduler::find_task(int _id) {
+    Pochoir_Task * l_task = pop_bottom(_id);
+    if (l_task != NULL || queued_.load() == 0)
+        return l_task;
+    const int l_groups = ngroups(), l_group = group_of(_id);
+    worker_deque & l_me = deques_[_id];
+    if (l_groups > 1 && (l_task = steal_top(inboxes_[l_group])) != NULL) {
+        l_me.placed_.fetch_add(1, std::memory_order_relaxed);
+        return l_task;
+    }
+    /* victims of our own group first, then the others */
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 1; i < nworkers_; ++i) {
+            const int l_victim = (_id + i) % nworkers_;
+            if ((group_of(l_victim) == l_group) != (pass == 0))
+                continue;
+            if (queued_.load() == 0)
+                return NULL;
+            if ((l_task = steal_top(deques_[l_victim])) != NULL) {
+                if (pass == 0)
+                    l_me.local_steals_.fetch_add(1, std::memory_order_relaxed);
+                else
+                    l_me.remote_steals_.fetch_add(1, std::memory_order_relaxed);
+                return l_task;
+            }
+        }
+    }
+    for (int g = 1; g < l_groups; ++g) {
+        if ((l_task = steal_top(inboxes_[(l_group + g) % l_groups])) != NULL) {
+            l_me.remote_steals_.fetch_add(1, std::memory_order_relaxed);
+            return l_task;
+        }
+    }
+    return NULL;
+}
+
+inline bool Pochoir_Scheduler::run_one(int _id) {
+    Pochoir_Task * l_task = find_task(_id);
+    if (l_task == NULL)
+        return false;
+    l_task->run();
+    Pochoir_Task_Group * l_tg = l_task->tg_;
+    delete l_task;
+    l_tg->done();
+    return true;
+}
+
+#define pochoir_spawn(_tg, ...) (_tg).spawn(__VA_ARGS__)
+#define pochoir_spawn_near(_tg, _pos, _len, ...) (_tg).spawn_near((_pos), (_len), __VA_ARGS__)
+#define pochoir_sync(_tg) (_tg).sync()
+
+/* pool threads are started lazily by the first spawn */
+template <typename Body>
+static inline void pochoir_parallel_region(Body const & body) { body(); }
+
+static inline int pochoir_get_nworkers() { return Pochoir_Scheduler::instance().nworkers(); }
+static inline int pochoir_max_workers() { return Pochoir_Scheduler::instance().max_workers(); }
+static inline int pochoir_worker_id() { return pochoir_tls_worker_id(); }
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    return Pochoir_Scheduler::instance().set_nworkers(atoi(nstr));
+}
+static inline int pochoir_numa_groups() { return Pochoir_Scheduler::instance().ngroups(); }
+static inline Pochoir_Steal_Stats pochoir_steal_stats() { return Pochoir_Scheduler::instance().steal_stats(); }
+static inline void pochoir_reset_steal_stats() { Pochoir_Scheduler::instance().reset_steal_stats(); }
+
+/* recursive halving, so the iterations are spread by stealing
+ * with grainsize = 1
+ */
+template <typename Body>
+static inline void pochoir_parallel_for(int _begin, int _end, Body const & body)
+{
+    if (pochoir_recording()) {
+        pochoir_record_parallel_for(_begin, _end, body);
+        return;
+    }
+    Pochoir_Task_Group l_tg;
+    while (_end - _begin > 1) {
+        int const l_mid = _begin + (_end - _begin) / 2;
+        int const l_end = _end;
+        pochoir_spawn(l_tg, [=, &body]{ pochoir_parallel_for(l_mid, l_end, body); });
+        _end = l_mid;
+    }
+    if (_begin < _end)
+        body(_begin);
+    pochoir_sync(l_tg);
+}
+
+#elif POCHOIR_BACKEND == POCHOIR_BACKEND_OPENMP
+/* ************************************************************************
+ * OpenMP backend : every spawn is an explicit task, every sync a taskwait.
+ * The walker runs inside one 'parallel' + 'single' region, so the rest of
+ * the team picks up the deferred tasks. If we are already inside an
+ * OpenMP parallel region (e.g. the user calls Run() from his own
+ * 'omp single'), the existing team is reused and no nested team is created,
+ * unless it has more threads than the per-worker slots, see below.
+ * ************************************************************************/
+#include <omp.h>
+
+/* OpenMP does not join child tasks at the end of a function,
+ * so the task group does it on destruction, like Cilk's implicit sync
+ */
+struct Pochoir_Task_Group {
+    Pochoir_Stage_Join join_;
+    ~Pochoir_Task_Group() {
+        if (!pochoir_recording()) {
+#pragma omp taskwait
+        }
+    }
+};
+
+#define pochoir_spawn(_tg, ...) \
+do { \
+    if (pochoir_recording()) { \
+        (_tg).join_.fork(__VA_ARGS__); \
+    } else { \
+        auto const l_task_fn_ = (__VA_ARGS__); \
+        _Pragma("omp task firstprivate(l_task_fn_)") \
+        l_task_fn_(); \
+    } \
+} while (0)
+
+#define pochoir_sync(_tg) \
+do { \
+    if (pochoir_recording()) { \
+        (_tg).join_.join(); \
+    } else { \
+        _Pragma("omp taskwait") \
+    } \
+} while (0)
+
+#define pochoir_spawn_near(_tg, _pos, _len, ...) pochoir_spawn(_tg, __VA_ARGS__)
+
+/* per-worker slots are sized once, omp_set_num_threads() beyond this
+ * bound is rejected by pochoir_set_nworkers()
+ */
+static inline int pochoir_max_workers() {
+    static int const l_max = (omp_get_max_threads() > omp_get_num_procs()) ? omp_get_max_threads() : omp_get_num_procs();
+    return l_max;
+}
+
+/* # of threads of a team we open, which never outgrows the slots */
+static inline int pochoir_team_size() {
+    return (omp_get_max_threads() < pochoir_max_workers()) ? omp_get_max_threads() : pochoir_max_workers();
+}
+
+/* An enclosing team is reused as long as the thread numbers of its
+ * members index the per-worker slots. A larger one (e.g. the user's
+ * 'parallel num_threads(8)' while the slots were sized for 2) gets a
+ * private nested team instead, which runs on the calling thread alone
+ * unless nested parallelism is enabled.
+ */
+template <typename Body>
+static inline void pochoir_parallel_region(Body const & body)
+{
+    if (omp_in_parallel() && omp_get_num_threads() <= pochoir_max_workers()) {
+        body();
+        return;
+    }
+#pragma omp parallel num_threads(pochoir_team_size())
+    {
+#pragma omp single
+        body();
+    }
+}
+
+template <typename Body>
+static inline void pochoir_parallel_for(int _begin, int _end, Body const & body)
+{
+    if (pochoir_recording()) {
+        pochoir_record_parallel_for(_begin, _end, body);
+        return;
+    }
+    if (omp_in_parallel() && omp_get_num_threads() <= pochoir_max_workers()) {
+#pragma omp taskloop grainsize(1)
+        for (int i = _begin; i < _end; ++i) {
+            body(i);
+        }
+    } else {
+#pragma omp parallel for schedule(dynamic, 1) num_threads(pochoir_team_size())
+        for (int i = _begin; i < _end; ++i) {
+            body(i);
+        }
+    }
+}
+
+static inline int pochoir_get_nworkers() { return pochoir_team_size(); }
+static inline int pochoir_worker_id() { return omp_get_thread_num(); }
+static inline bool pochoir_set_nworkers(const char * nstr) {
+    int const l_n = atoi(nstr);
+    if (l_n < 1 || l_n > pochoir_max_workers())
+        return false;
+    omp_set_num_threads(l_n);
+    return true;
+}
+
+#else /* POCHOIR_BACKEND == POCHOIR_BACKEND_SERIAL */
+/* ************************************************************************
+ * Serial backend : the serial elision of the walkers
+ * ************************************************************************/
+struct Pochoir_Task_Group {
+    Pochoir_Stage_Join join_;
+};
+
+/* Pochoir_Stage_Join::fork() runs the child inline, same as the elision */
+#define pochoir_spawn(_tg, ...) ((_tg).join_.fork(__VA_ARGS__))
+#define pochoir_spawn_near(_tg, _pos, _len, ...) pochoir_spawn(_tg, __VA_ARGS__)
+#define pochoir_sync(_tg) ((_tg).join_.join())
+
+template <typename Body>
+static inline void pochoir_parallel_for(int _begin, int _end, Body const & body)
+{
+    if (pochoir_recording()) {
+        pochoir_record_parallel_for(_begin, _end, body);
+        return;
+    }
+    for (int i = _begin; i < _end; ++i) {
+        body(i);
+    }
+}
+
+template <typename Body>
+static inline void pochoir_parallel_region(Body const & body) { body(); }
+
+static inline int pochoir_get_nworkers() { return 1; }
+static inline int pochoir_max_workers() { return 1; }
+static inline int pochoir_worker_id() { return 0; }
+static inline bool pochoir_set_nworkers(const char * nstr) { return atoi(nstr) == 1; }
+#endif /* POCHOIR_BACKEND == POCHOIR_BACKEND_NATIVE */
+
+/* per-worker slot storage shared by the native, OpenMP and serial backends */
+template <typename T>
+class Pochoir_Worker_Slots {
+    private:
+        struct slot { T v_; char pad_[POCHOIR_CACHE_LINE - sizeof(T) % POCHOIR_CACHE_LINE]; };
+        slot * slots_;
+        int n_;
+
+        /* under OpenMP the worker id is the thread number in the current
+         * team, so the slots also cover the team they are created in
+         */
+        static int count() {
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_OPENMP
+            return (omp_get_num_threads() > pochoir_max_workers()) ? omp_get_num_threads() : pochoir_max_workers();
+#else
+            return pochoir_max_workers();
+#endif
+        }
+    public:
+        Pochoir_Worker_Slots() : n_(count()) { slots_ = pochoir_aligned_new<slot>(n_); }
+        Pochoir_Worker_Slots(Pochoir_Worker_Slots const &) : n_(count()) { slots_ = pochoir_aligned_new<slot>(n_); }
+        Pochoir_Worker_Slots & operator= (Pochoir_Worker_Slots const &) { return *this; }
+        ~Pochoir_Worker_Slots() { pochoir_aligned_delete(slots_, n_); }
+        inline int size() const { return n_; }
+        inline T & operator[] (int _i) { return slots_[_i].v_; }
+        inline T const & operator[] (int _i) const { return slots_[_i].v_; }
+        inline T & local() {
+            const int l_id = pochoir_worker_id();
+#if POCHOIR_BACKEND == POCHOIR_BACKEND_OPENMP
+            if (l_id >= n_) {
+                printf("Pochoir OpenMP error:\n");
+                printf("Thread %d of a team of %d uses an object created for %d workers, create it inside the team!\n", l_id, omp_get_num_threads(), n_);
+                exit(1);
+            }
+#endif
+            return slots_[l_id].v_;
+        }
+};
+
+/* replacement of cilk::holder<T, cilk::holder_keep_last> :
+ * every worker gets its own temporary, copies of the holder
+ * never share slots
+ */
+template <typename T>
+class Pochoir_Holder {
+    private:
+        Pochoir_Worker_Slots<T> slots_;
+    public:
+        inline T & operator() () { return slots_.local(); }
+};
+
+/* replacement of cilk::reducer_opadd<T> */
+template <typename T>
+class Pochoir_Reducer_Opadd {
+    private:
+        Pochoir_Worker_Slots<T> slots_;
+    public:
+        Pochoir_Reducer_Opadd() {
+            for (int i = 0; i < slots_.size(); ++i)
+                slots_[i] = T(0);
+        }
+        inline Pochoir_Reducer_Opadd & operator++ () { ++slots_.local(); return *this; }
+        inline Pochoir_Reducer_Opadd & operator+= (T const & v) { slots_.local() += v; return *this; }
+        inline T get_value() const {
+            T l_sum = T(0);
+            for (int i = 0; i < slots_.size(); ++i)
+                l_sum += slots_[i];
+            return l_sum;
+        }
+};
+
+/* replacement of cilk::reducer<monoid> for the operators above, 
+ * get_value() folds the slots of all workers
+ */
+template <typename T, typename OP>
+class Pochoir_Reducer {
+    private:
+        Pochoir_Worker_Slots<T> slots_;
+    public:
+        Pochoir_Reducer() { reset(); }
+        inline void reset() {
+            for (int i = 0; i < slots_.size(); ++i)
+                slots_[i] = OP::identity();
+        }
+        inline void update(T const & v) {
+            T & l_local = slots_.local();
+            l_local = OP::apply(l_local, v);
+        }
+        inline T get_value() const {
+            T l_val = OP::identity();
+            for (int i = 0; i < slots_.size(); ++i)
+                l_val = OP::apply(l_val, slots_[i]);
+            return l_val;
+        }
+};
+#endif /* POCHOIR_BACKEND == POCHOIR_BACKEND_CILK */
+
+#if POCHOIR_BACKEND != POCHOIR_BACKEND_NATIVE
+static inline int pochoir_numa_groups() { return 1; }
+static inline Pochoir_Steal_Stats pochoir_steal_stats() {
+    Pochoir_Steal_Stats l_stats = { 0, 0, 0 };
+    return l_stats;
+}
+static inline void pochoir_reset_steal_stats() {}
+#endif
+
+#endif /* POCHOIR_PARALLEL_HPP */
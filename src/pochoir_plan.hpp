@@ -0,0 +1,124 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Zoid decomposition plan of one Run()/Run_Obase().
+ * A plan is recorded by running the walker serially with recorders in
+ * place of the kernels (see pochoir_begin_record() in pochoir_parallel.hpp) :
+ * no kernel is executed, every base case just lands in the plan as a leaf,
+ * tagged with its stage in the series-parallel order of the walk.
+ * Replaying the plan executes the leaves stage by stage, the leaves of
+ * one stage as a pochoir_parallel_for(), without any recursion or
+ * cut decision.
+ */
+#ifndef POCHOIR_PLAN_HPP
+#define POCHOIR_PLAN_HPP
+
+#include <vector>
+#include "pochoir_common.hpp"
+
+typedef enum {
+    /* obase kernel f(t0, t1, grid) */
+    POCHOIR_PLAN_OBASE = 0,
+    /* base_case_kernel_interior() */
+    POCHOIR_PLAN_INTERIOR,
+    /* base_case_kernel_boundary() */
+    POCHOIR_PLAN_BOUNDARY
+} Pochoir_Plan_Leaf_Type;
+
+template <int N_RANK>
+struct Pochoir_Plan_Leaf {
+    int kind;
+    int stage;
+    int t0, t1;
+    grid_info<N_RANK> grid;
+};
+
+template <int N_RANK>
+class Pochoir_Plan {
+    private:
+        std::vector<Pochoir_Plan_Leaf<N_RANK> > leaves_;
+        /* leaves_[stage_begin_[s] .. stage_begin_[s+1]) form stage s */
+        std::vector<int> stage_begin_;
+    public:
+        inline void add(int kind, int t0, int t1, grid_info<N_RANK> const & grid) {
+            Pochoir_Plan_Leaf<N_RANK> l_leaf;
+            l_leaf.kind = kind;
+            l_leaf.stage = pochoir_record_leaf();
+            l_leaf.t0 = t0; l_leaf.t1 = t1;
+            l_leaf.grid = grid;
+            leaves_.push_back(l_leaf);
+        }
+
+        /* group the leaves by stage, keeping the recording order inside
+         * a stage
+         */
+        void finalize() {
+            int l_stages = 0;
+            for (size_t i = 0; i < leaves_.size(); ++i) {
+                if (leaves_[i].stage + 1 > l_stages)
+                    l_stages = leaves_[i].stage + 1;
+            }
+            stage_begin_.assign(l_stages + 1, 0);
+            for (size_t i = 0; i < leaves_.size(); ++i)
+                ++stage_begin_[leaves_[i].stage + 1];
+            for (int s = 0; s < l_stages; ++s)
+                stage_begin_[s+1] += stage_begin_[s];
+            std::vector<int> l_pos(stage_begin_.begin(), stage_begin_.end() - 1);
+            std::vector<Pochoir_Plan_Leaf<N_RANK> > l_sorted(leaves_.size());
+            for (size_t i = 0; i < leaves_.size(); ++i)
+                l_sorted[l_pos[leaves_[i].stage]++] = leaves_[i];
+            leaves_.swap(l_sorted);
+        }
+
+        inline int size() const { return (int)leaves_.size(); }
+        inline int stages() const { return (int)stage_begin_.size() - 1; }
+
+        /* leaf_fn(Pochoir_Plan_Leaf<N_RANK> const &) executes one leaf */
+        template <typename Fn>
+        void replay(Fn const & leaf_fn) const {
+            for (int s = 0; s < stages(); ++s) {
+                int const l_begin = stage_begin_[s], l_end = stage_begin_[s+1];
+                if (l_end - l_begin == 1)
+                    leaf_fn(leaves_[l_begin]);
+                else
+                    pochoir_parallel_for(l_begin, l_end, [&](int i) { leaf_fn(leaves_[i]); });
+            }
+        }
+};
+
+/* stands in for a kernel while recording, Algorithm::base_case_kernel_*()
+ * have overloads for it
+ */
+template <int N_RANK>
+struct Pochoir_Plan_Recorder {
+    Pochoir_Plan<N_RANK> * plan_;
+    int kind_;
+    Pochoir_Plan_Recorder(Pochoir_Plan<N_RANK> * _plan, int _kind) : plan_(_plan), kind_(_kind) {}
+    inline void operator() (int t0, int t1, grid_info<N_RANK> const & grid) const {
+        plan_->add(kind_, t0, t1, grid);
+    }
+};
+
+#endif /* POCHOIR_PLAN_HPP */
@@ -29,6 +29,10 @@
 #ifndef POCHOIR_PROXY_H
 #define POCHOIR_PROXY_H
 
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
 /* if the type T is of a struct, the user has to employ the arrow operator '->'
  * to reference to the member, since the dot operator '.' is non-overload-able in C++
  */
@@ -74,4 +78,98 @@ private:
     T val_;
 };
 
+/* Structure-of-arrays layout : after Pochoir_SoA_Layout(T) at namespace
+ * scope, every Pochoir_Array<T, N> stores word k (of alignof(T) bytes) of
+ * all its elements contiguously in plane k, instead of storing the structs
+ * one after the other. A field of a scalar type lies within one word, so
+ * a kernel touching one field streams through one plane.
+ */
+template <typename T>
+struct pochoir_soa_layout { enum { value = 0 }; };
+
+#define Pochoir_SoA_Layout(T) \
+    template <> struct pochoir_soa_layout<T> { enum { value = 1 }; }
+
+/* Pochoir_SoA_Ref<T> stands for an element of an array in the
+ * structure-of-arrays layout : the accessors take one as a defaulted last
+ * argument, which lives until the end of the full expression, gather the
+ * element into it and return it, so that 'a(t, i).field = ...' works as
+ * usual. The words changed through it are scattered back when it dies. A
+ * reference to one of its fields must not be kept.
+ */
+template <typename T>
+class Pochoir_SoA_Ref : public T
+{
+public:
+    enum { word = alignof(T), nwords = sizeof(T) / alignof(T) };
+    Pochoir_SoA_Ref() : elem_(NULL) { }
+    Pochoir_SoA_Ref & bind(char * _elem, long _plane) {
+        char * l_val = (char *) static_cast<T *>(this);
+        for (int k = 0; k < nwords; ++k)
+            memcpy(l_val + k * word, _elem + k * _plane, word);
+        elem_ = _elem; plane_ = _plane;
+        orig_ = *static_cast<T *>(this);
+        return *this;
+    }
+    ~Pochoir_SoA_Ref() {
+        if (elem_ == NULL)
+            return;
+        /* compared to the gathered copy, so that two references to the
+         * same element in one expression only write their own changes
+         */
+        char const * l_val = (char const *) static_cast<T const *>(this);
+        char const * l_orig = (char const *) &orig_;
+        for (int k = 0; k < nwords; ++k)
+            if (memcmp(l_val + k * word, l_orig + k * word, word) != 0)
+                memcpy(elem_ + k * plane_, l_val + k * word, word);
+    }
+    Pochoir_SoA_Ref & operator= (T const & _v) {
+        static_cast<T &>(*this) = _v;
+        return *this;
+    }
+    Pochoir_SoA_Ref & operator= (Pochoir_SoA_Ref const & _v) {
+        static_cast<T &>(*this) = static_cast<T const &>(_v);
+        return *this;
+    }
+private:
+    Pochoir_SoA_Ref(Pochoir_SoA_Ref const &);
+    char * elem_;   /* word 0 of the element */
+    long plane_;    /* bytes from one word of the element to the next */
+    T orig_;
+};
+
+/* no scratch space is needed for the plain layout */
+struct Pochoir_No_Ref { };
+
+/* how Pochoir_Array<T, N> addresses its elements : ref(base, idx, ...)
+ * is the element at index idx (time slot included), which starts
+ * idx * word bytes past base, and its byte at offset 'off' lies
+ * field(off, plane) bytes further, where plane is 0 for the plain layout.
+ * bytes(n) is the offset of index n in bytes, size(n) the number of T
+ * that the storage of n elements takes (they differ from n * word and n
+ * for the bit-packed arrays, see pochoir_bits.hpp)
+ */
+template <typename T, bool SOA = pochoir_soa_layout<T>::value>
+struct Pochoir_Layout {
+    typedef T & reference;
+    typedef Pochoir_No_Ref scratch;
+    enum { soa = 0, bits = 0, word = sizeof(T) };
+    static inline reference ref(char * _base, long _idx, long, scratch &) { return *(T *)(_base + _idx * word); }
+    static inline long field(long _off, long) { return _off; }
+    static inline long bytes(long _n) { return _n * word; }
+    static inline long size(long _n) { return _n; }
+};
+
+template <typename T>
+struct Pochoir_Layout<T, true> {
+    static_assert(std::is_trivial<T>::value, "Pochoir_SoA_Layout() needs a trivial struct type");
+    typedef Pochoir_SoA_Ref<T> & reference;
+    typedef Pochoir_SoA_Ref<T> scratch;
+    enum { soa = 1, bits = 0, word = alignof(T) };
+    static inline reference ref(char * _base, long _idx, long _plane, scratch & _s) { return _s.bind(_base + _idx * word, _plane); }
+    static inline long field(long _off, long _plane) { return (_off / word) * _plane + _off % word; }
+    static inline long bytes(long _n) { return _n * word; }
+    static inline long size(long _n) { return _n; }
+};
+
 #endif /* POCHOIR_PROXY_H */
@@ -0,0 +1,113 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+
+/* Reductions fused into the base cases, see Pochoir::Run_Until().
+ * A Pochoir_Reduction folds a user expression e(t, i, j, ...) over all 
+ * grid points of one time step t with OP (sum/max/min). The expression
+ * is evaluated right after the kernel has computed time step t of a base
+ * zoid, on the slab of the zoid at time t, while it is still in cache,
+ * instead of a separate sweep over the whole grid afterwards. 
+ * Each base case folds its slab into a local partial result first, and
+ * only then into a per-worker Pochoir_Reducer<T, OP>.
+ *   Pochoir_Kernel_2D(res_fn, t, i, j)
+ *       return fabs(a(t, i, j) - a(t-1, i, j));
+ *   Pochoir_Kernel_End
+ *   auto res = pochoir_reduce_max<double>(res_fn);
+ */
+#ifndef POCHOIR_REDUCE_HPP
+#define POCHOIR_REDUCE_HPP
+
+#include "pochoir_common.hpp"
+#include "pochoir_walk.hpp"
+
+template <typename T, typename OP, typename E>
+class Pochoir_Reduction {
+    private:
+        E e_;
+        mutable Pochoir_Reducer<T, OP> r_;
+    public:
+        typedef T value_type;
+        Pochoir_Reduction(E const & _e) : e_(_e) {}
+        inline void reset() { r_.reset(); }
+        inline T value() const { return r_.get_value(); }
+
+        /* partial result of one base case */
+        struct Partial {
+            E const & e_;
+            mutable T v_;
+            Partial(E const & _e) : e_(_e), v_(OP::identity()) {}
+            template <typename... I>
+            inline void operator() (int t, I... idx) const { v_ = OP::apply(v_, e_(t, idx...)); }
+        };
+        inline Partial partial() const { return Partial(e_); }
+        inline void update(Partial const & p) const { r_.update(p.v_); }
+};
+
+template <typename T, typename E>
+inline Pochoir_Reduction<T, Pochoir_Reduce_Sum<T>, E> pochoir_reduce_sum(E const & e) {
+    return Pochoir_Reduction<T, Pochoir_Reduce_Sum<T>, E>(e);
+}
+
+template <typename T, typename E>
+inline Pochoir_Reduction<T, Pochoir_Reduce_Max<T>, E> pochoir_reduce_max(E const & e) {
+    return Pochoir_Reduction<T, Pochoir_Reduce_Max<T>, E>(e);
+}
+
+template <typename T, typename E>
+inline Pochoir_Reduction<T, Pochoir_Reduce_Min<T>, E> pochoir_reduce_min(E const & e) {
+    return Pochoir_Reduction<T, Pochoir_Reduce_Min<T>, E>(e);
+}
+
+/* kernel 'f' with reduction 'r' at time step 't_'. As a point kernel 
+ * it is picked up by the overloads of Algorithm::base_case_kernel_*(),
+ * as an obase kernel it is called on the whole zoid. Zoids never extend
+ * beyond the end of a Run()/Advance(), so with t_ the last time step of
+ * it, the slab at t_ is the top of the zoid and nothing of time t_ has
+ * been overwritten yet.
+ */
+template <typename F, typename R>
+struct Pochoir_Reduce_Kernel {
+    F const & f_;
+    R const & r_;
+    int t_;
+    Pochoir_Reduce_Kernel(F const & _f, R const & _r, int _t) : f_(_f), r_(_r), t_(_t) {}
+    template <int N_RANK>
+    inline void operator() (int t0, int t1, grid_info<N_RANK> const & grid) const {
+        f_(t0, t1, grid);
+        if (t0 <= t_ && t_ < t1) {
+            typename R::Partial l_partial = r_.partial();
+            meta_grid_interior<N_RANK, typename R::Partial>::single_step(t_, pochoir_zoid_slab(t0, grid, t_), grid, l_partial);
+            r_.update(l_partial);
+        }
+    }
+};
+
+template <typename F, typename R>
+inline Pochoir_Reduce_Kernel<F, R> pochoir_reduce_kernel(F const & f, R const & r, int t) {
+    return Pochoir_Reduce_Kernel<F, R>(f, r, t);
+}
+
+#endif /* POCHOIR_REDUCE_HPP */
@@ -0,0 +1,140 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Reduced-precision storage, see Pochoir_Stored_Array_ND(compute, storage).
+ * A bandwidth-bound stencil spends its time moving the elements, not
+ * computing on them, so an array may keep them in a narrower type
+ * (float for a double solver, pochoir_half or pochoir_bfloat16 for a
+ * float one) and convert each value up when it is read and down when it
+ * is written, in the accessors and in the generated pointer kernels alike.
+ */
+#ifndef POCHOIR_STORED_HPP
+#define POCHOIR_STORED_HPP
+
+#include <cstring>
+
+/* bfloat16 : the upper half of a float, rounded to nearest even */
+struct pochoir_bfloat16 {
+    unsigned short bits_;
+
+    pochoir_bfloat16() = default;
+    pochoir_bfloat16(float _f) {
+        unsigned int l_x;
+        memcpy(&l_x, &_f, sizeof(l_x));
+        if ((l_x & 0x7fffffff) > 0x7f800000)
+            bits_ = (unsigned short)((l_x >> 16) | 0x40); /* quiet NaN */
+        else
+            bits_ = (unsigned short)((l_x + 0x7fff + ((l_x >> 16) & 1)) >> 16);
+    }
+    operator float() const {
+        unsigned int l_x = (unsigned int)bits_ << 16;
+        float l_f;
+        memcpy(&l_f, &l_x, sizeof(l_f));
+        return l_f;
+    }
+};
+
+/* IEEE half precision : the compiler's _Float16 where it has one (with
+ * -mf16c the conversions are single instructions), bit twiddling otherwise
+ */
+#ifdef __FLT16_MAX__
+typedef _Float16 pochoir_half;
+#else
+struct pochoir_half {
+    unsigned short bits_;
+
+    pochoir_half() = default;
+    pochoir_half(float _f) {
+        unsigned int l_x;
+        memcpy(&l_x, &_f, sizeof(l_x));
+        const unsigned int l_sign = (l_x >> 16) & 0x8000, l_man = l_x & 0x7fffff;
+        const int l_exp = (int)((l_x >> 23) & 0xff) - 127 + 15;
+        unsigned int l_h, l_rem, l_mid;
+        if (((l_x >> 23) & 0xff) == 0xff) {
+            bits_ = (unsigned short)(l_sign | 0x7c00 | (l_man != 0 ? 0x200 : 0));
+            return;
+        }
+        if (l_exp >= 31) {
+            bits_ = (unsigned short)(l_sign | 0x7c00);
+            return;
+        }
+        if (l_exp <= 0) {
+            /* subnormal : the mantissa with its hidden bit, shifted */
+            const int l_shift = 14 - l_exp;
+            if (l_shift > 24) {
+                bits_ = (unsigned short)l_sign;
+                return;
+            }
+            const unsigned int l_full = l_man | 0x800000;
+            l_h = l_full >> l_shift;
+            l_rem = l_full & ((1u << l_shift) - 1);
+            l_mid = 1u << (l_shift - 1);
+        } else {
+            l_h = ((unsigned int)l_exp << 10) | (l_man >> 13);
+            l_rem = l_man & 0x1fff;
+            l_mid = 0x1000;
+        }
+        /* a carry out of the mantissa bumps the exponent, up to infinity */
+        if (l_rem > l_mid || (l_rem == l_mid && (l_h & 1)))
+            ++l_h;
+        bits_ = (unsigned short)(l_sign | l_h);
+    }
+    operator float() const {
+        const unsigned int l_sign = (unsigned int)(bits_ & 0x8000) << 16;
+        const unsigned int l_exp = (bits_ >> 10) & 0x1f, l_man = bits_ & 0x3ff;
+        unsigned int l_x;
+        if (l_exp == 0x1f)
+            l_x = l_sign | 0x7f800000 | (l_man << 13);
+        else if (l_exp != 0)
+            l_x = l_sign | ((l_exp + 112) << 23) | (l_man << 13);
+        else
+            return (l_sign ? -1.0f : 1.0f) * (float)l_man * (1.0f / 16777216.0f);
+        float l_f;
+        memcpy(&l_f, &l_x, sizeof(l_f));
+        return l_f;
+    }
+};
+#endif
+
+/* an element stored as S and computed on as C : it converts to C when
+ * read, and from C when assigned, so that a kernel written for an array
+ * of C works unchanged on it
+ */
+template <typename C, typename S>
+struct Pochoir_Stored {
+    typedef C compute_type;
+    typedef S storage_type;
+    S s_;
+
+    Pochoir_Stored() = default;
+    Pochoir_Stored(C const & _v) : s_(S(_v)) { }
+    operator C() const { return C(s_); }
+    Pochoir_Stored & operator+= (C const & _v) { s_ = S(C(s_) + _v); return *this; }
+    Pochoir_Stored & operator-= (C const & _v) { s_ = S(C(s_) - _v); return *this; }
+    Pochoir_Stored & operator*= (C const & _v) { s_ = S(C(s_) * _v); return *this; }
+    Pochoir_Stored & operator/= (C const & _v) { s_ = S(C(s_) / _v); return *this; }
+};
+
+#endif /* POCHOIR_STORED_HPP */
@@ -0,0 +1,173 @@
+/*
+ **********************************************************************************
+ *  Copyright (C) 2010-2011  Massachusetts Institute of Technology
+ *  Copyright (C) 2010-2011  Yuan Tang <yuantang@csail.mit.edu>
+ * 		                     Charles E. Leiserson <cel@mit.edu>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *   Suggestsions:                  yuantang@csail.mit.edu
+ *   Bugs:                          yuantang@csail.mit.edu
+ *
+ *********************************************************************************
+ */
+
+/* Persistent database of tuned base-case thresholds (dt_recursive_ /
+ * dx_recursive_[]). Pochoir::Tune()/Tune_Obase() search the coarsening
+ * space and record the winner, every later Run()/Run_Obase() with the same
+ * key picks it up from the database automatically.
+ * The database is a plain text file, one entry per line :
+ *   <key> <dt> <dx[N_RANK-1]> ... <dx[0]>
+ * The key encodes rank, entry point (r : Run, o/b : Run_Obase without/with
+ * boundary kernel), algorithm, slopes (<left>:<right> if they differ),
+ * toggle, bytes per grid point,
+ * grid size and worker count, e.g.
+ *   r2_kb_a0_s1,1_g2_e8_n1000,1000_w8 40 100 100
+ * The file name is taken from the environment variable POCHOIR_TUNE_FILE,
+ * and defaults to "pochoir_tune.txt" in the current directory.
+ */
+#ifndef POCHOIR_TUNE_HPP
+#define POCHOIR_TUNE_HPP
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <map>
+#include <vector>
+#include <mutex>
+#include "pochoir_common.hpp"
+
+#define POCHOIR_TUNE_FILE "pochoir_tune.txt"
+/* # of timed runs per candidate, the minimum is taken */
+#define POCHOIR_TUNE_REPEAT 2
+/* # of rounds of the coordinate search */
+#define POCHOIR_TUNE_ROUNDS 3
+/* a candidate has to be faster by this ratio to replace the incumbent */
+#define POCHOIR_TUNE_GAIN 0.97
+
+struct Pochoir_Tune_Entry {
+    int dt_thres;
+    std::vector<int> dx_thres;
+};
+
+class Pochoir_Tune_DB {
+    private:
+        std::map<std::string, Pochoir_Tune_Entry> entries_;
+        std::string file_;
+        bool loaded_;
+        std::mutex mtx_;
+
+        Pochoir_Tune_DB() : loaded_(false) {
+            const char * l_env = getenv("POCHOIR_TUNE_FILE");
+            file_ = (l_env == NULL) ? POCHOIR_TUNE_FILE : l_env;
+        }
+
+        void load() {
+            if (loaded_)
+                return;
+            loaded_ = true;
+            FILE * fp = fopen(file_.c_str(), "r");
+            if (fp == NULL)
+                return;
+            char l_line[1024];
+            while (fgets(l_line, sizeof(l_line), fp) != NULL) {
+                char * l_tok = strtok(l_line, " \t\n");
+                if (l_tok == NULL || l_tok[0] == '#')
+                    continue;
+                std::string l_key(l_tok);
+                Pochoir_Tune_Entry l_entry;
+                l_entry.dt_thres = 0;
+                if ((l_tok = strtok(NULL, " \t\n")) == NULL)
+                    continue;
+                l_entry.dt_thres = atoi(l_tok);
+                while ((l_tok = strtok(NULL, " \t\n")) != NULL)
+                    l_entry.dx_thres.push_back(atoi(l_tok));
+                entries_[l_key] = l_entry;
+            }
+            fclose(fp);
+        }
+
+        void save() {
+            FILE * fp = fopen(file_.c_str(), "w");
+            if (fp == NULL) {
+                printf("Pochoir tuning: failed to write %s\n", file_.c_str());
+                return;
+            }
+            fprintf(fp, "# Pochoir tuning database : <key> <dt> <dx[N_RANK-1]> ... <dx[0]>\n");
+            for (std::map<std::string, Pochoir_Tune_Entry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it) {
+                fprintf(fp, "%s %d", it->first.c_str(), it->second.dt_thres);
+                for (size_t i = 0; i < it->second.dx_thres.size(); ++i)
+                    fprintf(fp, " %d", it->second.dx_thres[i]);
+                fprintf(fp, "\n");
+            }
+            fclose(fp);
+        }
+
+    public:
+        static Pochoir_Tune_DB & instance() {
+            static Pochoir_Tune_DB l_db;
+            return l_db;
+        }
+
+        std::string const & file() const { return file_; }
+
+        /* dx_thres[] is ordered as in the file, the highest dimension first */
+        bool lookup(std::string const & _key, Pochoir_Tune_Entry & _entry) {
+            std::lock_guard<std::mutex> l_lock(mtx_);
+            load();
+            std::map<std::string, Pochoir_Tune_Entry>::const_iterator it = entries_.find(_key);
+            if (it == entries_.end())
+                return false;
+            _entry = it->second;
+            return true;
+        }
+
+        void record(std::string const & _key, Pochoir_Tune_Entry const & _entry) {
+            std::lock_guard<std::mutex> l_lock(mtx_);
+            /* re-read the file, another process may have added entries */
+            loaded_ = false;
+            load();
+            entries_[_key] = _entry;
+            save();
+        }
+};
+
+template <int N_RANK>
+static inline std::string tune_key(char _kind, Pochoir_Algor_Type _algor, int const * _lslope, int const * _rslope, int _toggle, int _bytes_per_point, grid_info<N_RANK> const & _grid, int _nworkers) {
+    char l_buf[64];
+    std::string l_key;
+    snprintf(l_buf, sizeof(l_buf), "r%d_k%c_a%d_s", N_RANK, _kind, (int)_algor);
+    l_key += l_buf;
+    for (int i = N_RANK-1; i >= 0; --i) {
+        if (_lslope[i] == _rslope[i])
+            snprintf(l_buf, sizeof(l_buf), "%d", _lslope[i]);
+        else
+            snprintf(l_buf, sizeof(l_buf), "%d:%d", _lslope[i], _rslope[i]);
+        l_key += l_buf;
+        if (i > 0)
+            l_key += ",";
+    }
+    snprintf(l_buf, sizeof(l_buf), "_g%d_e%d_n", _toggle, _bytes_per_point);
+    l_key += l_buf;
+    for (int i = N_RANK-1; i >= 0; --i) {
+        snprintf(l_buf, sizeof(l_buf), (i > 0) ? "%d," : "%d", _grid.x1[i] - _grid.x0[i]);
+        l_key += l_buf;
+    }
+    snprintf(l_buf, sizeof(l_buf), "_w%d", _nworkers);
+    l_key += l_buf;
+    return l_key;
+}
+
+#endif /* POCHOIR_TUNE_HPP */
@@ -29,10 +29,31 @@
 #include <cstdio>
 #include <cassert>
 #include <iostream>
-#include <cilk/cilk.h>
-#include <cilk/cilk_api.h>
-#include <cilk/reducer_opadd.h>
 #include "pochoir_common.hpp"
+#include "pochoir_plan.hpp"
+
+/* see pochoir_reduce.hpp */
+template <typename F, typename R>
+struct Pochoir_Reduce_Kernel;
+
+/* see pochoir_halo.hpp */
+template <int N_RANK, typename F>
+struct Pochoir_Halo_Kernel;
+
+/* see pochoir_file.hpp */
+template <int N_RANK, typename F>
+struct Pochoir_Advise_Kernel;
+
+/* slab of the zoid (t0, grid) at time t */
+template <int N_RANK>
+inline grid_info<N_RANK> pochoir_zoid_slab(int t0, grid_info<N_RANK> const & grid, int t) {
+    grid_info<N_RANK> l_grid = grid;
+    for (int i = 0; i < N_RANK; ++i) {
+        l_grid.x0[i] += grid.dx0[i] * (t - t0);
+        l_grid.x1[i] += grid.dx1[i] * (t - t0);
+    }
+    return l_grid;
+}
 
 using namespace std;
 
@@ -61,12 +82,14 @@ struct meta_grid_boundary <8, BF>{
             int new_o = pmod_lu(o, initial_grid.x0[1], initial_grid.x1[1]);
             for (int p = grid.x0[0]; p < grid.x1[0]; ++p) {
                 int new_p = pmod_lu(p, initial_grid.x0[0], initial_grid.x1[0]);
-                if (inRun) {
-                    home_cell_[8] = new_p; home_cell_[7] = new_o;
-                    home_cell_[6] = new_n; home_cell_[5] = new_m;
-                    home_cell_[4] = new_l; home_cell_[3] = new_k;
-                    home_cell_[2] = new_j; home_cell_[1] = new_i;
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[8] = new_p; pochoir_shape_check_.home_cell[7] = new_o;
+                    pochoir_shape_check_.home_cell[6] = new_n; pochoir_shape_check_.home_cell[5] = new_m;
+                    pochoir_shape_check_.home_cell[4] = new_l; pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j; pochoir_shape_check_.home_cell[1] = new_i;
                 }
+#endif
                 bf(t, new_i, new_j, new_k, new_l, new_m, new_n, new_o, new_p);
             } } } } } } } }
     }
@@ -90,12 +113,14 @@ struct meta_grid_boundary <7, BF>{
                 int new_n = pmod_lu(n, initial_grid.x0[1], initial_grid.x1[1]);
         for (int o = grid.x0[0]; o < grid.x1[0]; ++o) {
             int new_o = pmod_lu(o, initial_grid.x0[0], initial_grid.x1[0]);
-                if (inRun) {
-                    home_cell_[7] = new_o;
-                    home_cell_[6] = new_n; home_cell_[5] = new_m;
-                    home_cell_[4] = new_l; home_cell_[3] = new_k;
-                    home_cell_[2] = new_j; home_cell_[1] = new_i;
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[7] = new_o;
+                    pochoir_shape_check_.home_cell[6] = new_n; pochoir_shape_check_.home_cell[5] = new_m;
+                    pochoir_shape_check_.home_cell[4] = new_l; pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j; pochoir_shape_check_.home_cell[1] = new_i;
                 }
+#endif
                 bf(t, new_i, new_j, new_k, new_l, new_m, new_n, new_o);
             } } } } } } }
     }
@@ -117,11 +142,13 @@ struct meta_grid_boundary <6, BF>{
             int new_m = pmod_lu(m, initial_grid.x0[1], initial_grid.x1[1]);
             for (int n = grid.x0[0]; n < grid.x1[0]; ++n) {
                 int new_n = pmod_lu(n, initial_grid.x0[0], initial_grid.x1[0]);
-                if (inRun) {
-                    home_cell_[6] = new_n; home_cell_[5] = new_m;
-                    home_cell_[4] = new_l; home_cell_[3] = new_k;
-                    home_cell_[2] = new_j; home_cell_[1] = new_i;
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[6] = new_n; pochoir_shape_check_.home_cell[5] = new_m;
+                    pochoir_shape_check_.home_cell[4] = new_l; pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j; pochoir_shape_check_.home_cell[1] = new_i;
                 }
+#endif
                 bf(t, new_i, new_j, new_k, new_l, new_m, new_n);
             } } } } } } 
     }
@@ -141,11 +168,13 @@ struct meta_grid_boundary <5, BF>{
                 int new_l = pmod_lu(l, initial_grid.x0[1], initial_grid.x1[1]);
         for (int m = grid.x0[0]; m < grid.x1[0]; ++m) {
             int new_m = pmod_lu(m, initial_grid.x0[0], initial_grid.x1[0]);
-                if (inRun) {
-                    home_cell_[5] = new_m;
-                    home_cell_[4] = new_l; home_cell_[3] = new_k;
-                    home_cell_[2] = new_j; home_cell_[1] = new_i;
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[5] = new_m;
+                    pochoir_shape_check_.home_cell[4] = new_l; pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j; pochoir_shape_check_.home_cell[1] = new_i;
                 }
+#endif
                 bf(t, new_i, new_j, new_k, new_l, new_m);
             } } } } } 
     }
@@ -163,10 +192,12 @@ struct meta_grid_boundary <4, BF>{
             int new_k = pmod_lu(k, initial_grid.x0[1], initial_grid.x1[1]);
             for (int l = grid.x0[0]; l < grid.x1[0]; ++l) {
                 int new_l = pmod_lu(l, initial_grid.x0[0], initial_grid.x1[0]);
-                if (inRun) {
-                    home_cell_[4] = new_l; home_cell_[3] = new_k;
-                    home_cell_[2] = new_j; home_cell_[1] = new_i;
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[4] = new_l; pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j; pochoir_shape_check_.home_cell[1] = new_i;
                 }
+#endif
                 bf(t, new_i, new_j, new_k, new_l);
             } } } } 
     } 
@@ -182,11 +213,13 @@ struct meta_grid_boundary <3, BF>{
                 int new_j = pmod_lu(j, initial_grid.x0[1], initial_grid.x1[1]);
         for (int k = grid.x0[0]; k < grid.x1[0]; ++k) {
             int new_k = pmod_lu(k, initial_grid.x0[0], initial_grid.x1[0]);
-                do {
-                    home_cell_[3] = inRun ? new_k : 0;
-                    home_cell_[2] = inRun ? new_j : 0;
-                    home_cell_[1] = inRun ? new_i : 0;
-                } while (0);
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[3] = new_k;
+                    pochoir_shape_check_.home_cell[2] = new_j;
+                    pochoir_shape_check_.home_cell[1] = new_i;
+                }
+#endif
                 bf(t, new_i, new_j, new_k);
         } } }
 	} 
@@ -196,20 +229,43 @@ template <typename BF>
 struct meta_grid_boundary <2, BF>{
 	static inline void single_step(int t, grid_info<2> const & grid, grid_info<2> const & initial_grid, BF const & bf) {
 		for (int i = grid.x0[1]; i < grid.x1[1]; ++i) {
-#if (KLEIN == 0)
             int new_i = pmod_lu(i, initial_grid.x0[1], initial_grid.x1[1]);
-#endif
 			for (int j = grid.x0[0]; j < grid.x1[0]; ++j) {
-#if (KLEIN == 0)
                 int new_j = pmod_lu(j, initial_grid.x0[0], initial_grid.x1[0]);
-#else
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[2] = new_j;
+                    pochoir_shape_check_.home_cell[1] = new_i;
+                }
+#endif
+                bf(t, new_i, new_j);
+			} }
+	} 
+};
+
+/* boundary region of POCHOIR_TOPOLOGY_KLEIN, which only exists in 2D;
+ * other ranks never get here (see Pochoir::checkPolicy())
+ */
+template <int N_RANK, typename BF>
+struct meta_grid_boundary_klein {
+	static inline void single_step(int t, grid_info<N_RANK> const & grid, grid_info<N_RANK> const & initial_grid, BF const & bf) {
+        meta_grid_boundary<N_RANK, BF>::single_step(t, grid, initial_grid, bf);
+    }
+};
+
+template <typename BF>
+struct meta_grid_boundary_klein <2, BF>{
+	static inline void single_step(int t, grid_info<2> const & grid, grid_info<2> const & initial_grid, BF const & bf) {
+		for (int i = grid.x0[1]; i < grid.x1[1]; ++i) {
+			for (int j = grid.x0[0]; j < grid.x1[0]; ++j) {
                 int new_i = i, new_j = j;
                 klein(new_i, new_j, initial_grid);
+#ifdef CHECK_SHAPE
+                if (pochoir_shape_check_.in_run) {
+                    pochoir_shape_check_.home_cell[2] = new_j;
+                    pochoir_shape_check_.home_cell[1] = new_i;
+                }
 #endif
-                do {
-                    home_cell_[2] = inRun ? new_j : 0;
-                    home_cell_[1] = inRun ? new_i : 0;
-                } while (0);
                 bf(t, new_i, new_j);
 			} }
 	} 
@@ -220,9 +276,11 @@ struct meta_grid_boundary <1, BF>{
 	static inline void single_step(int t, grid_info<1> const & grid, grid_info<1> const & initial_grid, BF const & bf) {
 		for (int i = grid.x0[0]; i < grid.x1[0]; ++i) {
             int new_i = pmod_lu(i, initial_grid.x0[0], initial_grid.x1[0]);
-            do {
-                home_cell_[1] = inRun ? new_i : 0;
-            } while (0);
+#ifdef CHECK_SHAPE
+            if (pochoir_shape_check_.in_run) {
+                pochoir_shape_check_.home_cell[1] = new_i;
+            }
+#endif
 		    bf(t, new_i);
         }
 	} 
@@ -343,7 +401,7 @@ struct meta_grid_interior <1, F>{
 static inline void set_worker_count(const char * nstr) 
 {
 #if 1
-    if (0 != __cilkrts_set_param("nworkers", nstr)) {
+    if (!pochoir_set_nworkers(nstr)) {
         printf("Failed to set worker count\n");
     } else {
         printf("Successfully set worker count to %s\n", nstr);
@@ -388,29 +446,44 @@ struct Algorithm {
         /* we can use toggled circular queue! */
         grid_info<N_RANK> phys_grid_;
         int phys_length_[N_RANK];
-        int slope_[N_RANK];
+        /* a point depends on points at most lslope_[i] to the left (towards
+         * x0) and rslope_[i] to the right (towards x1) per time step,
+         * slope_[i] is the larger of the two. An upright zoid has
+         * dx0 = lslope_, dx1 = -rslope_, an inverted one dx0 = -rslope_,
+         * dx1 = lslope_, so one-sided stencils get wider zoids.
+         */
+        int slope_[N_RANK], lslope_[N_RANK], rslope_[N_RANK];
         int ulb_boundary[N_RANK], uub_boundary[N_RANK], lub_boundary[N_RANK];
         bool boundarySet, physGridSet, slopeSet;
+        Pochoir_Spawn_Type spawn_;
+        Pochoir_Topology_Type topology_;
+        Pochoir_Dim_Topology_Type dim_topology_[N_RANK];
 	public:
 #if STAT
     /* sim_count_cut will be accessed outside Algorithm object */
-    cilk::reducer_opadd<int> sim_count_cut[SUPPORT_RANK];
-    cilk::reducer_opadd<int> interior_region_count, boundary_region_count;
-    cilk::reducer_opadd<long long> interior_points_count, boundary_points_count;
+    Pochoir_Reducer_Opadd<int> sim_count_cut[SUPPORT_RANK];
+    Pochoir_Reducer_Opadd<int> interior_region_count, boundary_region_count;
+    Pochoir_Reducer_Opadd<long long> interior_points_count, boundary_points_count;
 #endif
 
     typedef enum {TILE_NCORES, TILE_BOUNDARY, TILE_MP} algor_type;
     
     /* constructor */
-    Algorithm (int const _slope[]) : dt_recursive_boundary_(1), r_t(1) {
+    Algorithm (int const _slope[]) : Algorithm(_slope, _slope) {}
+    Algorithm (int const _lslope[], int const _rslope[]) : dt_recursive_boundary_(1), r_t(1) {
         for (int i = 0; i < N_RANK; ++i) {
-            slope_[i] = _slope[i];
-            dx_recursive_boundary_[i] = _slope[i];
+            lslope_[i] = _lslope[i];
+            rslope_[i] = _rslope[i];
+            slope_[i] = max(_lslope[i], _rslope[i]);
+            dx_recursive_boundary_[i] = slope_[i];
 //            dx_recursive_boundary_[i] = tune_dx_boundary;
             ulb_boundary[i] = uub_boundary[i] = lub_boundary[i] = 0;
+            dim_topology_[i] = POCHOIR_DIM_PERIODIC;
             // dx_recursive_boundary_[i] = 10;
         }
         Z = 10000;
+        spawn_ = POCHOIR_SPAWN_RECURSIVE;
+        topology_ = POCHOIR_TOPOLOGY_TORUS;
         boundarySet = false;
         physGridSet = false;
         slopeSet = true;
@@ -421,9 +494,13 @@ struct Algorithm {
 //        for (int i = 0; i < SUPPORT_RANK; ++i) {
 //            sim_count_cut[i] = 0;
 //        }
-#else
-        N_CORES = __cilkrts_get_nworkers();
 #endif
+        /* the initial cut of the ncores walkers splits into N_CORES pieces,
+         * it has to be at least 2 to make progress on a single worker
+         */
+        N_CORES = pochoir_get_nworkers();
+        if (N_CORES < 2)
+            N_CORES = 2;
 //        cout << " N_CORES = " << N_CORES << endl;
 
     }
@@ -433,7 +510,17 @@ struct Algorithm {
      * - walk_ncores_hybrid
      * - walk_ncores_boundary
      */
-    inline void set_thres(int arr_type_size) {
+    /* set_thres() starts from the per-rank defaults, which were tuned
+     * for one array of doubles, and then halves the stopping sizes until
+     * the working set of a base zoid fits into half of the L2 cache.
+     * - arr_type_size : element size, sets the default length along the 
+     *   unit-stride dimension
+     * - bytes_per_point : sum of the element sizes over all registered
+     *   arrays and all their toggle levels
+     * A base zoid of height dt_recursive_ touches at most
+     * (dx_recursive_[i] + slope_[i] * dt_recursive_) points in dimension i.
+     */
+    inline void set_thres(int arr_type_size, int bytes_per_point) {
 #if 0
         dt_recursive_ = 1;
         dx_recursive_[0] = 1;
@@ -451,15 +538,80 @@ struct Algorithm {
         for (int i = N_RANK-1; i >= 1; --i)
             dx_recursive_[i] = (N_RANK == 2) ? (int)ceil(float(100 * sizeof(double))/arr_type_size): 10;
         }
+        const double l_budget = 0.5 * pochoir_cache_info().l2;
+        /* keep at least one cache line along the unit-stride dimension */
+        const int l_min_dx0 = max(1, 64 / max(1, arr_type_size));
+        while (true) {
+            double l_bytes = bytes_per_point;
+            int l_widest = -1;
+            double l_widest_len = 0;
+            /* on a tie, shrink the dimension with the largest stride first */
+            for (int i = N_RANK-1; i >= 0; --i) {
+                double l_len = dx_recursive_[i] + slope_[i] * dt_recursive_;
+                l_bytes *= l_len;
+                bool l_can_shrink = (dx_recursive_[i] > ((i == 0) ? l_min_dx0 : 2 * slope_[i] + 1)) || (dt_recursive_ > 1 && slope_[i] * dt_recursive_ > dx_recursive_[i]);
+                if (l_can_shrink && l_len > l_widest_len) {
+                    l_widest = i;
+                    l_widest_len = l_len;
+                }
+            }
+            if (l_bytes <= l_budget || l_widest < 0)
+                break;
+            /* shrink the height if the sloped faces dominate the width */
+            if (dt_recursive_ > 1 && slope_[l_widest] * dt_recursive_ > dx_recursive_[l_widest])
+                dt_recursive_ /= 2;
+            else
+                dx_recursive_[l_widest] = max((l_widest == 0) ? l_min_dx0 : 2 * slope_[l_widest] + 1, dx_recursive_[l_widest] / 2);
+        }
 #endif
 #if DEBUG
-        printf("arr_type_size = %d\n", arr_type_size);
+        printf("arr_type_size = %d, bytes_per_point = %d, L2 = %ld\n", arr_type_size, bytes_per_point, pochoir_cache_info().l2);
         printf("dt_thres = %d, ", dt_recursive_);
         for (int i = N_RANK-1; i >=1; --i)
             printf("dx_thres[%d] = %d, ", i, dx_recursive_[i]);
         printf("dx_thres[%d] = %d\n", 0, dx_recursive_[0]);
 #endif
     }
+    /* set_policy() must be called after set_thres(), non-zero thresholds
+     * of the policy override the defaults
+     */
+    inline void set_policy(Pochoir_Policy const & policy) {
+        spawn_ = policy.spawn;
+        topology_ = policy.topology;
+        for (int i = 0; i < N_RANK; ++i)
+            dim_topology_[i] = policy.dim_topology[i];
+        if (dim_topology_[0] == POCHOIR_DIM_TWISTED)
+            topology_ = POCHOIR_TOPOLOGY_KLEIN;
+        if (topology_ == POCHOIR_TOPOLOGY_KLEIN)
+            dim_topology_[0] = POCHOIR_DIM_TWISTED;
+        /* klein_region() mirrors zoids, which swaps left and right */
+        if (topology_ == POCHOIR_TOPOLOGY_KLEIN)
+            set_slope(slope_, slope_);
+        if (policy.dt_thres > 0)
+            dt_recursive_ = policy.dt_thres;
+        for (int i = 0; i < N_RANK; ++i) {
+            if (policy.dx_thres[i] > 0)
+                dx_recursive_[i] = policy.dx_thres[i];
+        }
+    }
+    /* whether the zoids wrap around in dimension i, i.e. the full
+     * dimension takes the initial cut
+     */
+    inline bool wraps(int i) const { return dim_topology_[i] == POCHOIR_DIM_PERIODIC || dim_topology_[i] == POCHOIR_DIM_TWISTED; }
+    /* position of the middle of the bottom of a zoid along the
+     * outermost dimension, in [0, phys_length_[N_RANK-1]), to spawn it
+     * near its data with pochoir_spawn_near(). Only the zoids of the
+     * top-level cuts, at least half a slab wide, are placed, the smaller
+     * ones stay with the worker spawning them (-1)
+     */
+    inline int home(grid_info<N_RANK> const & grid) const {
+        if (2 * (grid.x1[N_RANK-1] - grid.x0[N_RANK-1]) * pochoir_numa_groups() < phys_length_[N_RANK-1])
+            return -1;
+        const int l_mid = (grid.x0[N_RANK-1] + grid.x1[N_RANK-1]) / 2 - phys_grid_.x0[N_RANK-1];
+        return pmod_lu(l_mid, 0, phys_length_[N_RANK-1]);
+    }
+    inline int dt_thres() const { return dt_recursive_; }
+    inline int dx_thres(int i) const { return dx_recursive_[i]; }
     inline void push_queue(int dep, int level, int t0, int t1, grid_info<N_RANK> const & grid);
     inline queue_info & top_queue(int dep);
     inline void pop_queue(int dep);
@@ -467,7 +619,8 @@ struct Algorithm {
 
     void set_phys_grid(grid_info<N_RANK> const & grid);
     // void set_stride(int const stride[]);
-    void set_slope(int const slope[]);
+    void set_slope(int const slope[]) { set_slope(slope, slope); }
+    void set_slope(int const lslope[], int const rslope[]);
     inline bool touch_boundary(int i, int lt, grid_info<N_RANK> & grid);
 
     /* followings are the sim cut of both top and bottom bar */
@@ -519,6 +672,34 @@ struct Algorithm {
 	inline void base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
     template <typename BF> 
 	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf);
+    /* while recording a plan, base cases are only noted down */
+	inline void base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Plan_Recorder<N_RANK> const & f) {
+        f.plan_->add(POCHOIR_PLAN_INTERIOR, t0, t1, grid);
+    }
+	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Plan_Recorder<N_RANK> const & bf) {
+        bf.plan_->add(POCHOIR_PLAN_BOUNDARY, t0, t1, grid);
+    }
+    /* kernels with a fused reduction, see Pochoir_Reduce_Kernel */
+    template <typename F, typename R>
+	inline void base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Reduce_Kernel<F, R> const & f);
+    template <typename BF, typename R>
+	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Reduce_Kernel<BF, R> const & bf);
+    /* obase kernels on arrays with halos also take the boundary zoids */
+    template <typename F>
+	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Halo_Kernel<N_RANK, F> const & bf) {
+        bf(t0, t1, grid);
+    }
+    /* kernels hinting their footprint in file-backed arrays */
+    template <typename F>
+	inline void base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Advise_Kernel<N_RANK, F> const & f) {
+        f.advise(t0, t1, grid);
+        base_case_kernel_interior(t0, t1, grid, f.f_);
+    }
+    template <typename BF>
+	inline void base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Advise_Kernel<N_RANK, BF> const & bf) {
+        bf.advise(t0, t1, grid);
+        base_case_kernel_boundary(t0, t1, grid, bf.f_);
+    }
     template <typename F> 
 	inline void walk_serial(int t0, int t1, grid_info<N_RANK> const grid, F const & f);
 
@@ -574,25 +755,28 @@ void Algorithm<N_RANK>::set_phys_grid(grid_info<N_RANK> const & grid)
     if (slopeSet) {
         /* set up the lb/ub_boundary */
         for (int i = 0; i < N_RANK; ++i) {
-            ulb_boundary[i] = phys_grid_.x1[i] - slope_[i];
-            uub_boundary[i] = phys_grid_.x1[i] + slope_[i];
-            lub_boundary[i] = phys_grid_.x0[i] + slope_[i];
+            ulb_boundary[i] = phys_grid_.x1[i] - rslope_[i];
+            uub_boundary[i] = phys_grid_.x1[i] + lslope_[i];
+            lub_boundary[i] = phys_grid_.x0[i] + lslope_[i];
         }
     }
 }
 
 template <int N_RANK>
-void Algorithm<N_RANK>::set_slope(int const slope[])
+void Algorithm<N_RANK>::set_slope(int const lslope[], int const rslope[])
 {
-    for (int i = 0; i < N_RANK; ++i)
-        slope_[i] = slope[i];
+    for (int i = 0; i < N_RANK; ++i) {
+        lslope_[i] = lslope[i];
+        rslope_[i] = rslope[i];
+        slope_[i] = max(lslope[i], rslope[i]);
+    }
     slopeSet = true;
     if (physGridSet) {
         /* set up the lb/ub_boundary */
         for (int i = 0; i < N_RANK; ++i) {
-            ulb_boundary[i] = phys_grid_.x1[i] - slope_[i];
-            uub_boundary[i] = phys_grid_.x1[i] + slope_[i];
-            lub_boundary[i] = phys_grid_.x0[i] + slope_[i];
+            ulb_boundary[i] = phys_grid_.x1[i] - rslope_[i];
+            uub_boundary[i] = phys_grid_.x1[i] + lslope_[i];
+            lub_boundary[i] = phys_grid_.x0[i] + lslope_[i];
         }
     }
 }
@@ -615,9 +799,14 @@ template <int N_RANK> template <typename BF>
 inline void Algorithm<N_RANK>::base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf) {
 	grid_info<N_RANK> l_grid = grid;
 	for (int t = t0; t < t1; ++t) {
-        home_cell_[0] = t;
+#ifdef CHECK_SHAPE
+        pochoir_shape_check_.home_cell[0] = t;
+#endif
 		/* execute one single time step */
-		meta_grid_boundary<N_RANK, BF>::single_step(t, l_grid, phys_grid_, bf);
+        if (topology_ == POCHOIR_TOPOLOGY_TORUS)
+		    meta_grid_boundary<N_RANK, BF>::single_step(t, l_grid, phys_grid_, bf);
+        else
+		    meta_grid_boundary_klein<N_RANK, BF>::single_step(t, l_grid, phys_grid_, bf);
 
 		/* because the shape is trapezoid! */
 		for (int i = 0; i < N_RANK; ++i) {
@@ -626,6 +815,30 @@ inline void Algorithm<N_RANK>::base_case_kernel_boundary(int t0, int t1, grid_in
 	}
 }
 
+template <int N_RANK> template <typename F, typename R>
+inline void Algorithm<N_RANK>::base_case_kernel_interior(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Reduce_Kernel<F, R> const & f) {
+    base_case_kernel_interior(t0, t1, grid, f.f_);
+    if (t0 <= f.t_ && f.t_ < t1) {
+        typename R::Partial l_partial = f.r_.partial();
+        meta_grid_interior<N_RANK, typename R::Partial>::single_step(f.t_, pochoir_zoid_slab(t0, grid, f.t_), phys_grid_, l_partial);
+        f.r_.update(l_partial);
+    }
+}
+
+template <int N_RANK> template <typename BF, typename R>
+inline void Algorithm<N_RANK>::base_case_kernel_boundary(int t0, int t1, grid_info<N_RANK> const grid, Pochoir_Reduce_Kernel<BF, R> const & bf) {
+    base_case_kernel_boundary(t0, t1, grid, bf.f_);
+    if (t0 <= bf.t_ && bf.t_ < t1) {
+        typename R::Partial l_partial = bf.r_.partial();
+        grid_info<N_RANK> l_grid = pochoir_zoid_slab(t0, grid, bf.t_);
+        if (topology_ == POCHOIR_TOPOLOGY_TORUS)
+            meta_grid_boundary<N_RANK, typename R::Partial>::single_step(bf.t_, l_grid, phys_grid_, l_partial);
+        else
+            meta_grid_boundary_klein<N_RANK, typename R::Partial>::single_step(bf.t_, l_grid, phys_grid_, l_partial);
+        bf.r_.update(l_partial);
+    }
+}
+
 #if DEBUG 
 template <int N_RANK>
 void Algorithm<N_RANK>::print_grid(FILE *fp, int t0, int t1, grid_info<N_RANK> const & grid)
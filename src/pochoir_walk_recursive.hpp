@@ -39,34 +39,24 @@ inline bool Algorithm<N_RANK>::touch_boundary(int i, int lt, grid_info<N_RANK> &
     bool interior = false;
     if (grid.x0[i] >= uub_boundary[i] 
      && grid.x0[i] + grid.dx0[i] * lt >= uub_boundary[i]) {
-#if (KLEIN == 0)
-#if 1
-        /* this is for NON klein bottle */
-        interior = true;
-        /* by this branch, we are assuming the shape is NOT a Klein bottle */
-        grid.x0[i] -= phys_length_[i];
-        grid.x1[i] -= phys_length_[i];
-#else
-        interior = false;
-#endif
-#else
-        /* this is for klein bottle! */
-#if 1
+        if (topology_ == POCHOIR_TOPOLOGY_TORUS) {
+            /* this is for NON klein bottle */
+            interior = true;
+            grid.x0[i] -= phys_length_[i];
+            grid.x1[i] -= phys_length_[i];
+        } else {
+            /* this is for klein bottle! */
 #if DEBUG
-        fprintf(stderr, "Before klein_region: \n");
-        print_grid(stderr, 0, lt, grid);
+            fprintf(stderr, "Before klein_region: \n");
+            print_grid(stderr, 0, lt, grid);
 #endif
-        interior = true;
-//        fprintf(stderr, "call klein_region!\n");
-        klein_region(grid, phys_grid_);
+            interior = true;
+            klein_region(grid, phys_grid_);
 #if DEBUG
-        fprintf(stderr, "After klein_region: \n");
-        print_grid(stderr, 0, lt, grid);
-#endif
-#else
-        interior = false;
-#endif
+            fprintf(stderr, "After klein_region: \n");
+            print_grid(stderr, 0, lt, grid);
 #endif
+        }
     } else if (grid.x1[i] <= ulb_boundary[i] 
             && grid.x1[i] + grid.dx1[i] * lt <= ulb_boundary[i]
             && grid.x0[i] >= lub_boundary[i]
@@ -99,7 +89,7 @@ inline void Algorithm<N_RANK>::walk_serial(int t0, int t1, grid_info<N_RANK> con
     grid_info<N_RANK> l_grid;
 
     for (int i = 0; i < N_RANK; ++i) {
-        can_cut[i] = (2 * (grid.x1[i] - grid.x0[i]) + (grid.dx1[i] - grid.dx0[i]) * lt >= 4 * slope_[i] * lt) && (grid.x1[i] - grid.x0[i] > dx_recursive_[i]);
+        can_cut[i] = (2 * (grid.x1[i] - grid.x0[i]) + (grid.dx1[i] - grid.dx0[i]) * lt >= 2 * (lslope_[i] + rslope_[i]) * lt) && (grid.x1[i] - grid.x0[i] > dx_recursive_[i]);
         /* if all lb[i] < thres[i] && lt <= dt_recursive, 
            we have nothing to cut!
          */
@@ -117,11 +107,11 @@ inline void Algorithm<N_RANK>::walk_serial(int t0, int t1, grid_info<N_RANK> con
         for (int i = N_RANK-1; i >= 0 && !cut_yet; --i) {
             if (can_cut[i]) {
                 l_grid = grid;
-                int xm = (2 * (grid.x0[i] + grid.x1[i]) + (2 * slope_[i] + grid.dx0[i] + grid.dx1[i]) * lt) / 4;
+                int xm = (2 * (grid.x0[i] + grid.x1[i]) + (2 * rslope_[i] + grid.dx0[i] + grid.dx1[i]) * lt) / 4;
                 l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-                l_grid.x1[i] = xm; l_grid.dx1[i] = -slope_[i];
+                l_grid.x1[i] = xm; l_grid.dx1[i] = -rslope_[i];
                 walk_serial(t0, t1, l_grid, f);
-                l_grid.x0[i] = xm; l_grid.dx0[i] = -slope_[i];
+                l_grid.x0[i] = xm; l_grid.dx0[i] = -rslope_[i];
                 l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
                 walk_serial(t0, t1, l_grid, f);
 #if 0
@@ -161,6 +151,7 @@ inline void Algorithm<N_RANK>::walk_serial(int t0, int t1, grid_info<N_RANK> con
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::walk_bicut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+	Pochoir_Task_Group l_tg;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -170,7 +161,7 @@ inline void Algorithm<N_RANK>::walk_bicut(int t0, int t1, grid_info<N_RANK> cons
 
 	for (int i = 0; i < N_RANK; ++i) {
 		lb[i] = grid.x1[i] - grid.x0[i];
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 	}	
 
 	for (int i = N_RANK-1; i >= 0; --i) {
@@ -181,36 +172,36 @@ inline void Algorithm<N_RANK>::walk_bicut(int t0, int t1, grid_info<N_RANK> cons
 //			printf("initial_cut = %s, lb[%d] = %d, sep = %d, r = %d\n", initial_cut(i) ? "True" : "False", i, lb[i], sep, r);
 #endif
 			l_grid.x0[i] = grid.x0[i];
-			l_grid.dx0[i] = slope_[i];
+			l_grid.dx0[i] = lslope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
-			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn [&]{walk_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = -rslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{walk_bicut(t0, t1, l_grid, f);});
 
 			l_grid.x0[i] = grid.x0[i] + sep;
-			l_grid.dx0[i] = slope_[i];
+			l_grid.dx0[i] = lslope_[i];
 			l_grid.x1[i] = grid.x1[i];
-			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn [&]{walk_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = -rslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{walk_bicut(t0, t1, l_grid, f);});
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
-			if (grid.dx0[i] != slope_[i]) {
+			pochoir_sync(l_tg);
+			if (grid.dx0[i] != lslope_[i]) {
 				l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-				cilk_spawn [&]{walk_bicut(t0, t1, l_grid, f);}();
+				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = lslope_[i];
+				pochoir_spawn(l_tg, [=, &f]{walk_bicut(t0, t1, l_grid, f);});
 			}
 
 			l_grid.x0[i] = grid.x0[i] + sep;
-			l_grid.dx0[i] = -slope_[i];
+			l_grid.dx0[i] = -rslope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
-			l_grid.dx1[i] = slope_[i];
-			cilk_spawn [&]{walk_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = lslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{walk_bicut(t0, t1, l_grid, f);});
 
-			if (grid.dx1[i] != -slope_[i]) {
-				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
+			if (grid.dx1[i] != -rslope_[i]) {
+				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -rslope_[i];
 				l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-				cilk_spawn [&]{walk_bicut(t0, t1, l_grid, f);}();
+				pochoir_spawn(l_tg, [=, &f]{walk_bicut(t0, t1, l_grid, f);});
 			}
 #if DEBUG
 			printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -278,6 +269,7 @@ do { \
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -294,26 +286,33 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    shorter_duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0)
-                    shorter_duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn [&]{shorter_duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);}();
-#endif
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        shorter_duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
+                } else {
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0)
+                        shorter_duo_sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);
+                    else
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f]{shorter_duo_sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);});
+                }
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -321,11 +320,11 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = slope_[level] * lt;
+                const int lthres = lslope_[level] * lt, rthres = rslope_[level] * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb < tb);
-                const bool can_cut = cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]);
+                const bool can_cut = cut_lb ? (lb >= (lthres + rthres) && lb > dx_recursive_[level]) : (tb >= (lthres + rthres) && lb > dx_recursive_[level]);
                 if (!can_cut) {
                     /* if we can't cut into this dimension, just directly push 
                      * it into the circular queue 
@@ -334,7 +333,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                 } else {
                     /* can_cut! */
                     if (cut_lb) {
-                        const int mid = (lb/2);
+                        const int mid = (lb + lthres - rthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -342,10 +341,10 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                         /* push the middle triangular minizoid (gray) into 
                          * circular queue of (curr_dep) 
                          */
-                        l_son_grid.x0[level] = l_start + mid - thres;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + thres;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - lthres;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + rthres;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -355,15 +354,15 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                          */
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - thres;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - lthres;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push the right big trapezoid (black)
                          * into circular queue of (curr_dep + 1)
                          */
-                        l_son_grid.x0[level] = l_start + mid + thres;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + rthres;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -371,7 +370,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                     } /* end if (cut_lb) */
                     else {
                         /* cut_tb */
-                        const int mid = (tb/2);
+                        const int mid = (tb + rthres - lthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -381,12 +380,12 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
                         l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push right black sub-grid into circular queue of (curr_dep) */
                         l_son_grid.x0[level] = ul_start + mid;;
-                        l_son_grid.dx0[level] = slope_[level];
+                        l_son_grid.dx0[level] = lslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -397,17 +396,15 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
                          * circular queue of (curr_dep + 1)
                          */
                         l_son_grid.x0[level] = ul_start + mid;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } /* end else (cut_tb) */
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -417,6 +414,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut(int t0, int t1, g
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -433,27 +431,34 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    shorter_duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0) {
-                    shorter_duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        shorter_duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
                 } else {
-                    cilk_spawn [&]{shorter_duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);}();
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0) {
+                        shorter_duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);
+                    } else {
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f, &bf]{shorter_duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);});
+                    }
                 }
-#endif
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -461,12 +466,12 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = slope_[level] * lt;
+                const int lthres = lslope_[level] * lt, rthres = rslope_[level] * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb < tb);
                 const bool l_touch_boundary = touch_boundary(level, lt, l_father_grid);
-                const bool can_cut = cut_lb ? (l_touch_boundary ? (lb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (lb >= 2 * thres && lb > dx_recursive_[level])) : (l_touch_boundary ? (tb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]));
+                const bool can_cut = cut_lb ? (l_touch_boundary ? (lb >= (lthres + rthres) && lb > dx_recursive_boundary_[level]) : (lb >= (lthres + rthres) && lb > dx_recursive_[level])) : (l_touch_boundary ? (tb >= (lthres + rthres) && lb > dx_recursive_boundary_[level]) : (tb >= (lthres + rthres) && lb > dx_recursive_[level]));
                 if (!can_cut) {
                     /* if we can't cut into this dimension, just directly push
                      * it into the circular queue
@@ -477,7 +482,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                     if (cut_lb) {
                         /* if cutting lb, there's no initial cut! */
                         assert(lb != phys_length_[level] || l_father_grid.dx0[level] != 0 || l_father_grid.dx1[level] != 0);
-                        const int mid = lb/2;
+                        const int mid = (lb + lthres - rthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -485,10 +490,10 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                         /* push the middle gray minizoid
                          * into circular queue of (curr_dep) 
                          */
-                        l_son_grid.x0[level] = l_start + mid - thres;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + thres;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - lthres;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + rthres;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -496,43 +501,43 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - thres;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - lthres;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
-                        l_son_grid.x0[level] = l_start + mid + thres;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + rthres;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } /* end if (cut_lb) */
                     else { /* cut_tb */
-                        if (lb == phys_length_[level] && l_father_grid.dx0[level] == 0 && l_father_grid.dx1[level] == 0) { /* initial cut on the dimension */
+                        if (lb == phys_length_[level] && l_father_grid.dx0[level] == 0 && l_father_grid.dx1[level] == 0 && wraps(level)) { /* initial cut on the dimension */
                             assert(l_father_grid.dx0[level] == 0);
                             assert(l_father_grid.dx1[level] == 0);
-                            const int mid = tb/2;
+                            const int mid = (tb + rthres - lthres)/2;
                             grid_info<N_RANK> l_son_grid = l_father_grid;
                             const int l_start = (l_father_grid.x0[level]);
                             const int l_end = (l_father_grid.x1[level]);
                             const int ul_start = (l_father_grid.x0[level] + l_father_grid.dx0[level] * lt);
                             /* merge the big black trapezoids */
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end + (ul_start - l_start) + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* cilk_sync */
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push middle minizoid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         } else { /* NOT the initial cut! */
-                            const int mid = tb/2;
+                            const int mid = (tb + rthres - lthres)/2;
                             grid_info<N_RANK> l_son_grid = l_father_grid;
                             const int l_start = (l_father_grid.x0[level]);
                             const int l_end = (l_father_grid.x1[level]);
@@ -541,12 +546,12 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                             l_son_grid.x0[level] = l_start;
                             l_son_grid.dx0[level] = l_father_grid.dx0[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* push one sub-grid into circular queue of (curr_dep) */
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end;
                             l_son_grid.dx1[level] = l_father_grid.dx1[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -555,18 +560,16 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push one sub-grid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         }                    
                     } /* end if (cut_tb) */
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -575,6 +578,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_space_cut_p(int t0, int t1,
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -591,26 +595,33 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0)
-                    duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn [&]{duo_sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);}();
-#endif
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        duo_sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
+                } else {
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0)
+                        duo_sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);
+                    else
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f]{duo_sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);});
+                }
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -618,7 +629,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = 2 * slope_[level] * lt;
+                const int thres = (lslope_[level] + rslope_[level]) * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb >= tb);
@@ -640,12 +651,12 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
                         l_son_grid.x1[level] = l_start + mid;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push one sub-grid into circular queue of (curr_dep) */
                         l_son_grid.x0[level] = l_start + mid;
-                        l_son_grid.dx0[level] = slope_[level];
+                        l_son_grid.dx0[level] = lslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -654,25 +665,25 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                         const int next_dep_pointer = (curr_dep + 1) & 0x1;
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
                         l_son_grid.x0[level] = l_start + mid;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_start + mid;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                     } /* end if (cut_lb) */
                     else {
                         /* cut_tb */
-                        const int delta_x = (lt * slope_[level]);
-                        const int mid = (lb/2);
+                        const int delta_l = (lt * lslope_[level]), delta_r = (lt * rslope_[level]);
+                        const int mid = (lb + delta_l - delta_r)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
 
                         /* push one sub-grid into circular queue of (curr_dep) */
-                        l_son_grid.x0[level] = l_start + mid - delta_x;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + delta_x;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - delta_l;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + delta_r;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -680,13 +691,13 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - delta_x;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - delta_l;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
-                        l_son_grid.x0[level] = l_start + mid + delta_x;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + delta_r;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -694,9 +705,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -705,6 +714,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut(int t0, int t1, grid_info
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -721,27 +731,34 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0) {
-                    duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        duo_sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
                 } else {
-                    cilk_spawn [&]{duo_sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);}();
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0) {
+                        duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);
+                    } else {
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f, &bf]{duo_sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);});
+                    }
                 }
-#endif
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -749,7 +766,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = 2 * slope_[level] * lt;
+                const int thres = (lslope_[level] + rslope_[level]) * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb >= tb);
@@ -763,7 +780,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                 } else {
                     /* can_cut */
                     if (cut_lb) {
-                        if (lb == phys_length_[level]) { /* initial cut on the dimension */
+                        if (lb == phys_length_[level] && wraps(level)) { /* initial cut on the dimension */
                             const int mid = (int)lb/2;
                             grid_info<N_RANK> l_son_grid = l_father_grid;
                             const int l_start = (l_father_grid.x0[level]);
@@ -771,32 +788,32 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
 
                             /* push one sub-grid into circular queue of (curr_dep) */
                             l_son_grid.x0[level] = l_start;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_start + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* push one sub-grid into circular queue of (curr_dep) */
                             l_son_grid.x0[level] = l_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* cilk_sync */
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push one sub-grid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = l_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = l_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* initial cut - merge triangles! */
                             l_son_grid.x0[level] = l_end;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = l_end;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         } else { /* NOT the initial cut! */
                             const int mid = (int)lb/2;
@@ -808,12 +825,12 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                             l_son_grid.x0[level] = l_start;
                             l_son_grid.dx0[level] = l_father_grid.dx0[level];
                             l_son_grid.x1[level] = l_start + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* push one sub-grid into circular queue of (curr_dep) */
                             l_son_grid.x0[level] = l_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end;
                             l_son_grid.dx1[level] = l_father_grid.dx1[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -822,26 +839,26 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push one sub-grid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = l_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = l_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         }
                     } /* end if (cut_lb) */
                     else { /* cut_tb */
                         /* if cutting tb, there's no initial cut! */
                         assert(tb != phys_length_[level]);
-                        const int mid = (int)lb/2;
-                        const int delta_x = (lt * slope_[level]);
+                        const int delta_l = (lt * lslope_[level]), delta_r = (lt * rslope_[level]);
+                        const int mid = (lb + delta_l - delta_r)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
 
                         /* push one sub-grid into circular queue of (curr_dep) */
-                        l_son_grid.x0[level] = l_start + mid - delta_x;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + delta_x;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - delta_l;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + delta_r;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -849,23 +866,21 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - delta_x;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - delta_l;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
-                        l_son_grid.x0[level] = l_start + mid + delta_x;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + delta_r;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } /* end if (cut_tb) */
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -873,6 +888,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_space_cut_p(int t0, int t1, grid_in
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -889,26 +905,33 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0)
-                    sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn [&]{sim_obase_bicut(l_father->t0, l_father->t1, l_father->grid, f);}();
-#endif
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        sim_obase_bicut(l_son->t0, l_son->t1, l_son->grid, f);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
+                } else {
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0)
+                        sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);
+                    else
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f]{sim_obase_bicut(l_son.t0, l_son.t1, l_son.grid, f);});
+                }
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -916,7 +939,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = 2 * slope_[level] * lt;
+                const int thres = (lslope_[level] + rslope_[level]) * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const bool can_cut = (lb >= 2 * thres && lb > dx_recursive_[level]);
                 if (!can_cut) {
@@ -933,17 +956,17 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
 
                     /* push one sub-grid into circular queue of (curr_dep) */
                     l_son_grid.x0[level] = l_start;
-                    l_son_grid.dx0[level] = slope_[level];
+                    l_son_grid.dx0[level] = lslope_[level];
                     l_son_grid.x1[level] = l_start + mid;
-                    l_son_grid.dx1[level] = -slope_[level];
+                    l_son_grid.dx1[level] = -rslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                     /* push one sub-grid into circular queue of (curr_dep) */
                     l_son_grid.x0[level] = l_start + mid;
-                    l_son_grid.dx0[level] = slope_[level];
+                    l_son_grid.dx0[level] = lslope_[level];
                     l_son_grid.x1[level] = l_end;
-                    l_son_grid.dx1[level] = -slope_[level];
+                    l_son_grid.dx1[level] = -rslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
@@ -951,23 +974,23 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
                     const int next_dep_pointer = (curr_dep + 1) & 0x1;
                     /* push one sub-grid into circular queue of (curr_dep + 1)*/
                     l_son_grid.x0[level] = l_start + mid;
-                    l_son_grid.dx0[level] = -slope_[level];
+                    l_son_grid.dx0[level] = -rslope_[level];
                     l_son_grid.x1[level] = l_start + mid;
-                    l_son_grid.dx1[level] = slope_[level];
+                    l_son_grid.dx1[level] = lslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
-                    if (l_father_grid.dx0[level] != slope_[level]) {
+                    if (l_father_grid.dx0[level] != lslope_[level]) {
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
                         l_son_grid.x1[level] = l_start;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     }
-                    if (l_father_grid.dx1[level] != -slope_[level]) {
+                    if (l_father_grid.dx1[level] != -rslope_[level]) {
                         l_son_grid.x0[level] = l_end;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
@@ -976,9 +999,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -987,6 +1008,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut(int t0, int t1, grid_info<N_R
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1003,27 +1025,34 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0) {
-                    sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        sim_obase_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
                 } else {
-                    cilk_spawn [&]{sim_obase_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);}();
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0) {
+                        sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);
+                    } else {
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f, &bf]{sim_obase_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);});
+                    }
                 }
-#endif
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -1031,7 +1060,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = 2 * slope_[level] * lt;
+                const int thres = (lslope_[level] + rslope_[level]) * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const bool l_touch_boundary = touch_boundary(level, lt, l_father_grid);
                 const bool can_cut = l_touch_boundary ? (lb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (lb >= 2 * thres && lb > dx_recursive_[level]);
@@ -1049,17 +1078,17 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
 
                     /* push one sub-grid into circular queue of (curr_dep) */
                     l_son_grid.x0[level] = l_start;
-                    l_son_grid.dx0[level] = slope_[level];
+                    l_son_grid.dx0[level] = lslope_[level];
                     l_son_grid.x1[level] = l_start + mid;
-                    l_son_grid.dx1[level] = -slope_[level];
+                    l_son_grid.dx1[level] = -rslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                     /* push one sub-grid into circular queue of (curr_dep) */
                     l_son_grid.x0[level] = l_start + mid;
-                    l_son_grid.dx0[level] = slope_[level];
+                    l_son_grid.dx0[level] = lslope_[level];
                     l_son_grid.x1[level] = l_end;
-                    l_son_grid.dx1[level] = -slope_[level];
+                    l_son_grid.dx1[level] = -rslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
@@ -1067,32 +1096,32 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
                     const int next_dep_pointer = (curr_dep + 1) & 0x1;
                     /* push one sub-grid into circular queue of (curr_dep + 1)*/
                     l_son_grid.x0[level] = l_start + mid;
-                    l_son_grid.dx0[level] = -slope_[level];
+                    l_son_grid.dx0[level] = -rslope_[level];
                     l_son_grid.x1[level] = l_start + mid;
-                    l_son_grid.dx1[level] = slope_[level];
+                    l_son_grid.dx1[level] = lslope_[level];
                     assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                     push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
-                    if (lb == phys_length_[level]) {
+                    if (lb == phys_length_[level] && wraps(level)) {
                         /* initial cut - merge triangles! */
                         l_son_grid.x0[level] = l_end;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } else {
-                        if (l_father_grid.dx0[level] != slope_[level]) {
+                        if (l_father_grid.dx0[level] != lslope_[level]) {
                             l_son_grid.x0[level] = l_start;
                             l_son_grid.dx0[level] = l_father_grid.dx0[level];
                             l_son_grid.x1[level] = l_start;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         }
-                        if (l_father_grid.dx1[level] != -slope_[level]) {
+                        if (l_father_grid.dx1[level] != -rslope_[level]) {
                             l_son_grid.x0[level] = l_end;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = l_end;
                             l_son_grid.dx1[level] = l_father_grid.dx1[level];
                             assert(l_son_grid.x0[level] <= l_son_grid.x1[level]);
@@ -1102,9 +1131,7 @@ inline void Algorithm<N_RANK>::sim_obase_space_cut_p(int t0, int t1, grid_info<N
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -1128,8 +1155,8 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_bicut(int t0, int t1, grid_
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
         bool cut_lb = (lb < tb);
-        thres = (slope_[i] * lt);
-        sim_can_cut = sim_can_cut || (cut_lb ? ((lb >= (2 * thres)) & (lb > dx_recursive_[i])) : ((tb >= (2 * thres)) & (lb > dx_recursive_[i])));
+        thres = ((lslope_[i] + rslope_[i]) * lt);
+        sim_can_cut = sim_can_cut || (cut_lb ? ((lb >= thres) & (lb > dx_recursive_[i])) : ((tb >= thres) & (lb > dx_recursive_[i])));
         /* as long as there's one dimension can conduct a cut, we conduct a 
          * multi-dimensional cut!
          */
@@ -1201,7 +1228,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_bicut(int t0, int t1, grid_info<N_R
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
         bool cut_lb = (lb >= tb);
-        thres = (2 * slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         sim_can_cut = sim_can_cut || (cut_lb ? ((lb >= 2 * thres) & (lb > dx_recursive_[i])) : ((tb >= 2 * thres) & (lb > dx_recursive_[i])));
         /* as long as there's one dimension can conduct a cut, we conduct a 
          * multi-dimensional cut!
@@ -1276,14 +1303,14 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_bicut_p(int t0, int t1, gri
         bool l_touch_boundary = touch_boundary(i, lt, l_father_grid);
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
-        thres = (slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         /* l_father_grid may be mapped to a new region in touch_boundary() */
         /* for the initial cut, we exclude the begining and end point to minimize
          * the overhead on boundary
         */
         /* lb == phys_length_[i] indicates an initial cut! */
         bool cut_lb = (lb < tb);
-        sim_can_cut = sim_can_cut || (cut_lb ? (l_touch_boundary ? ((lb >= 2 * thres) & (lb > dx_recursive_boundary_[i])) : ((lb >= 2 * thres) & (lb > dx_recursive_[i]))) : (l_touch_boundary ? ((tb >= 2 * thres) & (lb > dx_recursive_boundary_[i])) : ((tb > 2 * thres) & (lb > dx_recursive_[i]))));
+        sim_can_cut = sim_can_cut || (cut_lb ? (l_touch_boundary ? ((lb >= thres) & (lb > dx_recursive_boundary_[i])) : ((lb >= thres) & (lb > dx_recursive_[i]))) : (l_touch_boundary ? ((tb >= thres) & (lb > dx_recursive_boundary_[i])) : ((tb > thres) & (lb > dx_recursive_[i]))));
         call_boundary |= l_touch_boundary;
 #if STAT
         l_count_cut = (l_can_cut ? l_count_cut + 1 : l_count_cut);
@@ -1365,6 +1392,7 @@ inline void Algorithm<N_RANK>::shorter_duo_sim_obase_bicut_p(int t0, int t1, gri
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1381,26 +1409,33 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    stevenj_bicut(l_son->t0, l_son->t1, l_son->grid, f);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0)
-                    stevenj_bicut(l_father->t0, l_father->t1, l_father->grid, f);
-                else
-                    cilk_spawn [&]{stevenj_bicut(l_father->t0, l_father->t1, l_father->grid, f);}();
-#endif
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        stevenj_bicut(l_son->t0, l_son->t1, l_son->grid, f);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
+                } else {
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0)
+                        stevenj_bicut(l_son.t0, l_son.t1, l_son.grid, f);
+                    else
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f]{stevenj_bicut(l_son.t0, l_son.t1, l_son.grid, f);});
+                }
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -1408,11 +1443,11 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = slope_[level] * lt;
+                const int lthres = lslope_[level] * lt, rthres = rslope_[level] * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb < tb);
-                const bool can_cut = cut_lb ? (lb >= 2 * thres && lb > dx_recursive_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]);
+                const bool can_cut = cut_lb ? (lb >= (lthres + rthres) && lb > dx_recursive_[level]) : (tb >= (lthres + rthres) && lb > dx_recursive_[level]);
                 if (!can_cut) {
                     /* if we can't cut into this dimension, just directly push 
                      * it into the circular queue 
@@ -1421,7 +1456,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                 } else {
                     /* can_cut! */
                     if (cut_lb) {
-                        const int mid = (lb/2);
+                        const int mid = (lb + lthres - rthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -1429,10 +1464,10 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                         /* push the middle triangular minizoid (gray) into 
                          * circular queue of (curr_dep) 
                          */
-                        l_son_grid.x0[level] = l_start + mid - thres;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + thres;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - lthres;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + rthres;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -1442,15 +1477,15 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                          */
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - thres;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - lthres;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push the right big trapezoid (black)
                          * into circular queue of (curr_dep + 1)
                          */
-                        l_son_grid.x0[level] = l_start + mid + thres;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + rthres;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -1458,7 +1493,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                     } /* end if (cut_lb) */
                     else {
                         /* cut_tb */
-                        const int mid = (tb/2);
+                        const int mid = (tb + rthres - lthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -1468,12 +1503,12 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
                         l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push right black sub-grid into circular queue of (curr_dep) */
                         l_son_grid.x0[level] = ul_start + mid;;
-                        l_son_grid.dx0[level] = slope_[level];
+                        l_son_grid.dx0[level] = lslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -1484,17 +1519,15 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
                          * circular queue of (curr_dep + 1)
                          */
                         l_son_grid.x0[level] = ul_start + mid;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = ul_start + mid;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } /* end else (cut_tb) */
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -1504,6 +1537,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut(int t0, int t1, grid_info<N_RAN
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+    Pochoir_Task_Group l_tg;
     queue_info *l_father;
     queue_info circular_queue_[2][ALGOR_QUEUE_SIZE];
     int queue_head_[2], queue_tail_[2], queue_len_[2];
@@ -1520,27 +1554,34 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
             top_queue(curr_dep_pointer, l_father);
             if (l_father->level < 0) {
                 /* spawn all the grids in circular_queue_[curr_dep][] */
-#if USE_CILK_FOR 
-                /* use cilk_for to spawn all the sub-grid */
-// #pragma cilk_grainsize = 1
-                cilk_for (int j = 0; j < queue_len_[curr_dep_pointer]; ++j) {
-                    int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
-                    queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
-                    /* assert all the sub-grid has done N_RANK spatial cuts */
-                    assert(l_son->level == -1);
-                    stevenj_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
-                } /* end cilk_for */
-                queue_head_[curr_dep_pointer] = queue_tail_[curr_dep_pointer] = 0;
-                queue_len_[curr_dep_pointer] = 0;
-#else
-                /* use cilk_spawn to spawn all the sub-grid */
-                pop_queue(curr_dep_pointer);
-                if (queue_len_[curr_dep_pointer] == 0) {
-                    stevenj_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);
+                if (spawn_ == POCHOIR_SPAWN_PARALLEL_FOR) {
+                    /* use pochoir_parallel_for to spawn all the sub-grid */
+                    /* only the leading run of fully cut sub-grids is ready,
+                     * the rest of the queue may still need space cuts
+                     */
+                    int l_ready = 0;
+                    while (l_ready < queue_len_[curr_dep_pointer] 
+                        && circular_queue_[curr_dep_pointer][pmod(queue_head_[curr_dep_pointer]+l_ready, ALGOR_QUEUE_SIZE)].level < 0)
+                        ++l_ready;
+                    pochoir_parallel_for(0, l_ready, [&](int j) {
+                        int i = pmod((queue_head_[curr_dep_pointer]+j), ALGOR_QUEUE_SIZE);
+                        queue_info * l_son = &(circular_queue_[curr_dep_pointer][i]);
+                        /* assert all the sub-grid has done N_RANK spatial cuts */
+                        assert(l_son->level == -1);
+                        stevenj_bicut_p(l_son->t0, l_son->t1, l_son->grid, f, bf);
+                    }); /* end pochoir_parallel_for */
+                    for (int j = 0; j < l_ready; ++j)
+                        pop_queue(curr_dep_pointer);
                 } else {
-                    cilk_spawn [&]{stevenj_bicut_p(l_father->t0, l_father->t1, l_father->grid, f, bf);}();
+                    /* use pochoir_spawn to spawn all the sub-grid */
+                    pop_queue(curr_dep_pointer);
+                    const queue_info l_son = *l_father;
+                    if (queue_len_[curr_dep_pointer] == 0) {
+                        stevenj_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);
+                    } else {
+                        pochoir_spawn_near(l_tg, home(l_son.grid), phys_length_[N_RANK-1], [=, &f, &bf]{stevenj_bicut_p(l_son.t0, l_son.t1, l_son.grid, f, bf);});
+                    }
                 }
-#endif
             } else {
                 /* performing a space cut on dimension 'level' */
                 pop_queue(curr_dep_pointer);
@@ -1548,12 +1589,12 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                 const int t0 = l_father->t0, t1 = l_father->t1;
                 const int lt = (t1 - t0);
                 const int level = l_father->level;
-                const int thres = slope_[level] * lt;
+                const int lthres = lslope_[level] * lt, rthres = rslope_[level] * lt;
                 const int lb = (l_father_grid.x1[level] - l_father_grid.x0[level]);
                 const int tb = (l_father_grid.x1[level] + l_father_grid.dx1[level] * lt - l_father_grid.x0[level] - l_father_grid.dx0[level] * lt);
                 const bool cut_lb = (lb < tb);
                 const bool l_touch_boundary = touch_boundary(level, lt, l_father_grid);
-                const bool can_cut = cut_lb ? (l_touch_boundary ? (lb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (lb >= 2 * thres && lb > dx_recursive_[level])) : (l_touch_boundary ? (tb >= 2 * thres && lb > dx_recursive_boundary_[level]) : (tb >= 2 * thres && lb > dx_recursive_[level]));
+                const bool can_cut = cut_lb ? (l_touch_boundary ? (lb >= (lthres + rthres) && lb > dx_recursive_boundary_[level]) : (lb >= (lthres + rthres) && lb > dx_recursive_[level])) : (l_touch_boundary ? (tb >= (lthres + rthres) && lb > dx_recursive_boundary_[level]) : (tb >= (lthres + rthres) && lb > dx_recursive_[level]));
                 if (!can_cut) {
                     /* if we can't cut into this dimension, just directly push
                      * it into the circular queue
@@ -1564,7 +1605,7 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                     if (cut_lb) {
                         /* if cutting lb, there's no initial cut! */
                         assert(lb != phys_length_[level] || l_father_grid.dx0[level] != 0 || l_father_grid.dx1[level] != 0);
-                        const int mid = lb/2;
+                        const int mid = (lb + lthres - rthres)/2;
                         grid_info<N_RANK> l_son_grid = l_father_grid;
                         const int l_start = (l_father_grid.x0[level]);
                         const int l_end = (l_father_grid.x1[level]);
@@ -1572,10 +1613,10 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                         /* push the middle gray minizoid
                          * into circular queue of (curr_dep) 
                          */
-                        l_son_grid.x0[level] = l_start + mid - thres;
-                        l_son_grid.dx0[level] = slope_[level];
-                        l_son_grid.x1[level] = l_start + mid + thres;
-                        l_son_grid.dx1[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid - lthres;
+                        l_son_grid.dx0[level] = lslope_[level];
+                        l_son_grid.x1[level] = l_start + mid + rthres;
+                        l_son_grid.dx1[level] = -rslope_[level];
                         push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* cilk_sync */
@@ -1583,43 +1624,43 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
                         l_son_grid.x0[level] = l_start;
                         l_son_grid.dx0[level] = l_father_grid.dx0[level];
-                        l_son_grid.x1[level] = l_start + mid - thres;
-                        l_son_grid.dx1[level] = slope_[level];
+                        l_son_grid.x1[level] = l_start + mid - lthres;
+                        l_son_grid.dx1[level] = lslope_[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
 
                         /* push one sub-grid into circular queue of (curr_dep + 1)*/
-                        l_son_grid.x0[level] = l_start + mid + thres;
-                        l_son_grid.dx0[level] = -slope_[level];
+                        l_son_grid.x0[level] = l_start + mid + rthres;
+                        l_son_grid.dx0[level] = -rslope_[level];
                         l_son_grid.x1[level] = l_end;
                         l_son_grid.dx1[level] = l_father_grid.dx1[level];
                         push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                     } /* end if (cut_lb) */
                     else { /* cut_tb */
-                        if (lb == phys_length_[level] && l_father_grid.dx0[level] == 0 && l_father_grid.dx1[level] == 0) { /* initial cut on the dimension */
+                        if (lb == phys_length_[level] && l_father_grid.dx0[level] == 0 && l_father_grid.dx1[level] == 0 && wraps(level)) { /* initial cut on the dimension */
                             assert(l_father_grid.dx0[level] == 0);
                             assert(l_father_grid.dx1[level] == 0);
-                            const int mid = tb/2;
+                            const int mid = (tb + rthres - lthres)/2;
                             grid_info<N_RANK> l_son_grid = l_father_grid;
                             const int l_start = (l_father_grid.x0[level]);
                             const int l_end = (l_father_grid.x1[level]);
                             const int ul_start = (l_father_grid.x0[level] + l_father_grid.dx0[level] * lt);
                             /* merge the big black trapezoids */
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end + (ul_start - l_start) + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* cilk_sync */
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push middle minizoid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         } else { /* NOT the initial cut! */
-                            const int mid = tb/2;
+                            const int mid = (tb + rthres - lthres)/2;
                             grid_info<N_RANK> l_son_grid = l_father_grid;
                             const int l_start = (l_father_grid.x0[level]);
                             const int l_end = (l_father_grid.x1[level]);
@@ -1628,12 +1669,12 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                             l_son_grid.x0[level] = l_start;
                             l_son_grid.dx0[level] = l_father_grid.dx0[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = -slope_[level];
+                            l_son_grid.dx1[level] = -rslope_[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
 
                             /* push one sub-grid into circular queue of (curr_dep) */
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = slope_[level];
+                            l_son_grid.dx0[level] = lslope_[level];
                             l_son_grid.x1[level] = l_end;
                             l_son_grid.dx1[level] = l_father_grid.dx1[level];
                             push_queue(curr_dep_pointer, level-1, t0, t1, l_son_grid);
@@ -1642,18 +1683,16 @@ inline void Algorithm<N_RANK>::stevenj_space_cut_p(int t0, int t1, grid_info<N_R
                             const int next_dep_pointer = (curr_dep + 1) & 0x1;
                             /* push one sub-grid into circular queue of (curr_dep + 1)*/
                             l_son_grid.x0[level] = ul_start + mid;
-                            l_son_grid.dx0[level] = -slope_[level];
+                            l_son_grid.dx0[level] = -rslope_[level];
                             l_son_grid.x1[level] = ul_start + mid;
-                            l_son_grid.dx1[level] = slope_[level];
+                            l_son_grid.dx1[level] = lslope_[level];
                             push_queue(next_dep_pointer, level-1, t0, t1, l_son_grid);
                         }                    
                     } /* end if (cut_tb) */
                 } /* end if (can_cut) */
             } /* end if (performing a space cut) */
         } /* end while (queue_len_[curr_dep] > 0) */
-#if !USE_CILK_FOR
-        cilk_sync;
-#endif
+        pochoir_sync(l_tg);
         assert(queue_len_[curr_dep_pointer] == 0);
     } /* end for (curr_dep < N_RANK+1) */
 }
@@ -1671,8 +1710,8 @@ inline void Algorithm<N_RANK>::stevenj_bicut(int t0, int t1, grid_info<N_RANK> c
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
         bool cut_lb = (lb < tb);
-        thres = (slope_[i] * lt);
-        sim_can_cut = sim_can_cut || (cut_lb ? ((lb >= 2 * thres) & (lb > dx_recursive_[i])) : ((tb >= 2 * thres) & (lb > dx_recursive_[i])));
+        thres = ((lslope_[i] + rslope_[i]) * lt);
+        sim_can_cut = sim_can_cut || (cut_lb ? ((lb >= thres) & (lb > dx_recursive_[i])) : ((tb >= thres) & (lb > dx_recursive_[i])));
     }
 
     if (sim_can_cut) {
@@ -1702,14 +1741,14 @@ inline void Algorithm<N_RANK>::stevenj_bicut_p(int t0, int t1, grid_info<N_RANK>
         bool l_touch_boundary = touch_boundary(i, lt, l_father_grid);
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
-        thres = (slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         /* l_father_grid may be mapped to a new region in touch_boundary() */
         /* for the initial cut, we exclude the begining and end point to minimize
          * the overhead on boundary
         */
         /* lb == phys_length_[i] indicates an initial cut! */
         bool cut_lb = (lb < tb);
-        sim_can_cut = sim_can_cut || (cut_lb ? (l_touch_boundary ? ((lb >= 2 * thres) & (lb > dx_recursive_boundary_[i])) : ((lb >= 2 * thres) & (lb > dx_recursive_[i]))) : (l_touch_boundary ? ((tb >= 2 * thres) & (lb > dx_recursive_boundary_[i])) : ((tb > 2 * thres) & (lb > dx_recursive_[i]))));
+        sim_can_cut = sim_can_cut || (cut_lb ? (l_touch_boundary ? ((lb >= thres) & (lb > dx_recursive_boundary_[i])) : ((lb >= thres) & (lb > dx_recursive_[i]))) : (l_touch_boundary ? ((tb >= thres) & (lb > dx_recursive_boundary_[i])) : ((tb > thres) & (lb > dx_recursive_[i]))));
         call_boundary |= l_touch_boundary;
     }
 
@@ -1777,7 +1816,7 @@ inline void Algorithm<N_RANK>::duo_sim_obase_bicut_p(int t0, int t1, grid_info<N
         bool l_touch_boundary = touch_boundary(i, lt, l_father_grid);
         lb = (grid.x1[i] - grid.x0[i]);
         tb = (grid.x1[i] + grid.dx1[i] * lt - grid.x0[i] - grid.dx0[i] * lt);
-        thres = (2 * slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         /* l_father_grid may be mapped to a new region in touch_boundary() */
         /* for the initial cut, we exclude the begining and end point to minimize
          * the overhead on boundary
@@ -1880,7 +1919,7 @@ inline void Algorithm<N_RANK>::sim_obase_bicut(int t0, int t1, grid_info<N_RANK>
     for (int i = N_RANK-1; i >= 0; --i) {
         int lb, thres, tb;
         lb = (grid.x1[i] - grid.x0[i]);
-        thres = (2 * slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         sim_can_cut = sim_can_cut || ((lb >= 2 * thres) & (lb > dx_recursive_[i]));
         /* as long as there's one dimension can conduct a cut, we conduct a 
          * multi-dimensional cut!
@@ -1955,7 +1994,7 @@ inline void Algorithm<N_RANK>::sim_obase_bicut_p(int t0, int t1, grid_info<N_RAN
         int lb, thres;
         bool l_touch_boundary = touch_boundary(i, lt, l_father_grid);
         lb = (grid.x1[i] - grid.x0[i]);
-        thres = (2 * slope_[i] * lt);
+        thres = ((lslope_[i] + rslope_[i]) * lt);
         /* l_father_grid may be mapped to a new region in touch_boundary() */
         /* for the initial cut, we exclude the begining and end point to minimize
          * the overhead on boundary
@@ -2045,6 +2084,7 @@ inline void Algorithm<N_RANK>::sim_obase_bicut_p(int t0, int t1, grid_info<N_RAN
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+	Pochoir_Task_Group l_tg;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2058,7 +2098,7 @@ inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> c
 
 	for (int i = 0; i < N_RANK; ++i) {
 		lb[i] = grid.x1[i] - grid.x0[i];
-		thres[i] = (initial_cut(i)) ? N_CORES * (2 * slope_[i] * lt) : 2 * (2 * slope_[i] * lt);
+		thres[i] = (initial_cut(i)) ? N_CORES * ((lslope_[i] + rslope_[i]) * lt) : 2 * ((lslope_[i] + rslope_[i]) * lt);
 		base_cube = base_cube && (lb[i] <= dx_recursive_[i] || lb[i] < thres[i]); 
 //		base_cube = base_cube && (lb[i] < thres[i]); 
 	}	
@@ -2074,7 +2114,7 @@ inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> c
 			if (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]) { 
 //			if (lb[i] >= thres[i]) { 
 				l_grid = grid;
-				int sep = (initial_cut(i)) ? lb[i]/N_CORES : (2 * slope_[i] * lt);
+				int sep = (initial_cut(i)) ? lb[i]/N_CORES : ((lslope_[i] + rslope_[i]) * lt);
 				int r = (initial_cut(i)) ? N_CORES : (lb[i]/sep);
 #if DEBUG
 				printf("initial_cut = %s, lb[%d] = %d, sep = %d, r = %d\n", initial_cut(i) ? "True" : "False", i, lb[i], sep, r);
@@ -2082,37 +2122,37 @@ inline void Algorithm<N_RANK>::walk_adaptive(int t0, int t1, grid_info<N_RANK> c
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = slope_[i];
+					l_grid.dx0[i] = lslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
-					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn [&]{walk_adaptive(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = -rslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{walk_adaptive(t0, t1, l_grid, f);});
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
-				l_grid.dx0[i] = slope_[i];
+				l_grid.dx0[i] = lslope_[i];
 				l_grid.x1[i] = grid.x1[i];
-				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn [&]{walk_adaptive(t0, t1, l_grid, f);}();
+				l_grid.dx1[i] = -rslope_[i];
+				pochoir_spawn(l_tg, [=, &f]{walk_adaptive(t0, t1, l_grid, f);});
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
-				if (grid.dx0[i] != slope_[i]) {
+				pochoir_sync(l_tg);
+				if (grid.dx0[i] != lslope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{walk_adaptive(t0, t1, l_grid, f);}();
+					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{walk_adaptive(t0, t1, l_grid, f);});
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = -slope_[i];
+					l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
-					l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{walk_adaptive(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{walk_adaptive(t0, t1, l_grid, f);});
 				}
-				if (grid.dx1[i] != -slope_[i]) {
-					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
+				if (grid.dx1[i] != -rslope_[i]) {
+					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn [&]{walk_adaptive(t0, t1, l_grid, f);}();
+					pochoir_spawn(l_tg, [=, &f]{walk_adaptive(t0, t1, l_grid, f);});
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2155,6 +2195,7 @@ static int count_internal = 0;
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2168,7 +2209,7 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 		call_boundary |= l_touch_boundary[i];
 	}	
 
@@ -2182,19 +2223,19 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 			int l_end = (l_father_grid.x1[i]);
 
 			l_son_grid.x0[i] = l_start;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = -slope_[i];
+			l_son_grid.dx1[i] = -rslope_[i];
             if (call_boundary) {
-                cilk_spawn [&]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
             } else {
-                cilk_spawn [&]{walk_bicut(t0, t1, l_son_grid, f);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_bicut(t0, t1, l_son_grid, f);});
             }
 
 			l_son_grid.x0[i] = l_start + sep;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_end;
-			l_son_grid.dx1[i] = -slope_[i];
+			l_son_grid.dx1[i] = -rslope_[i];
             if (call_boundary) {
                 walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
             } else {
@@ -2203,50 +2244,50 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 #if DEBUG
 			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync(l_tg);
 
 			l_son_grid.x0[i] = l_start + sep;
-			l_son_grid.dx0[i] = -slope_[i];
+			l_son_grid.dx0[i] = -rslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = slope_[i];
+			l_son_grid.dx1[i] = lslope_[i];
             if (call_boundary) {
-                cilk_spawn [&]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
             } else {
-                cilk_spawn [&]{walk_bicut(t0, t1, l_son_grid, f);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_bicut(t0, t1, l_son_grid, f);});
             }
 
-			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
         //        printf("merge triagles!\n");
 				l_son_grid.x0[i] = l_end;
-				l_son_grid.dx0[i] = -slope_[i];
+				l_son_grid.dx0[i] = -rslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = slope_[i];
+				l_son_grid.dx1[i] = lslope_[i];
                 if (call_boundary) {
-                    cilk_spawn [&]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                 } else {
-                    cilk_spawn [&]{walk_bicut(t0, t1, l_son_grid, f);}();
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_bicut(t0, t1, l_son_grid, f);});
                 }
 			} else {
-				if (l_father_grid.dx0[i] != slope_[i]) {
+				if (l_father_grid.dx0[i] != lslope_[i]) {
 					l_son_grid.x0[i] = l_start; 
 					l_son_grid.dx0[i] = l_father_grid.dx0[i];
 					l_son_grid.x1[i] = l_start; 
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{walk_bicut(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_bicut(t0, t1, l_son_grid, f);});
                     }
 				}
-				if (l_father_grid.dx1[i] != -slope_[i]) {
+				if (l_father_grid.dx1[i] != -rslope_[i]) {
 					l_son_grid.x0[i] = l_end; 
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{walk_bicut(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_bicut(t0, t1, l_son_grid, f);});
                     }
 				}
 			}
@@ -2307,6 +2348,7 @@ inline void Algorithm<N_RANK>::walk_bicut_boundary_p(int t0, int t1, grid_info<N
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2319,7 +2361,7 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = (initial_cut(i)) ?  N_CORES * (2 * slope_[i] * lt) : 2 * (2 * slope_[i] * lt);
+		thres[i] = (initial_cut(i)) ?  N_CORES * ((lslope_[i] + rslope_[i]) * lt) : 2 * ((lslope_[i] + rslope_[i]) * lt);
 		call_boundary |= l_touch_boundary[i];
 		if (l_touch_boundary[i])
 			base_cube = base_cube && (lb[i] <= dx_recursive_boundary_[i] || lb[i] < thres[i]); 
@@ -2351,26 +2393,26 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 			can_cut = (l_touch_boundary[i]) ? (lb[i] >= thres[i] && lb[i] > dx_recursive_boundary_[i]) : (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]);
 			if (can_cut) { 
 				l_son_grid = l_father_grid;
-                int sep = (initial_cut(i)) ? lb[i]/N_CORES : (2 * slope_[i] * lt);
+                int sep = (initial_cut(i)) ? lb[i]/N_CORES : ((lslope_[i] + rslope_[i]) * lt);
                 int r = (initial_cut(i)) ? N_CORES : (lb[i]/sep);
 				int l_start = (l_father_grid.x0[i]);
 				int l_end = (l_father_grid.x1[i]);
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = slope_[i];
+					l_son_grid.dx0[i] = lslope_[i];
 					l_son_grid.x1[i] = l_start + sep * (j+1);
-					l_son_grid.dx1[i] = -slope_[i];
+					l_son_grid.dx1[i] = -rslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{walk_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_adaptive(t0, t1, l_son_grid, f);});
                     }
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
-				l_son_grid.dx0[i] = slope_[i];
+				l_son_grid.dx0[i] = lslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = -slope_[i];
+				l_son_grid.dx1[i] = -rslope_[i];
                 if (call_boundary) {
                     walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);
                 } else {
@@ -2379,50 +2421,50 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync(l_tg);
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{walk_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_adaptive(t0, t1, l_son_grid, f);});
                     }
 				}
-				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
             //        printf("merge triagles!\n");
 					l_son_grid.x0[i] = l_end;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end;
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{walk_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_adaptive(t0, t1, l_son_grid, f);});
                     }
 				} else {
-					if (l_father_grid.dx0[i] != slope_[i]) {
+					if (l_father_grid.dx0[i] != lslope_[i]) {
 						l_son_grid.x0[i] = l_start; 
 						l_son_grid.dx0[i] = l_father_grid.dx0[i];
 						l_son_grid.x1[i] = l_start; 
-						l_son_grid.dx1[i] = slope_[i];
+						l_son_grid.dx1[i] = lslope_[i];
                         if (call_boundary) {
-                            cilk_spawn [&]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);});
                         } else {
-                            cilk_spawn [&]{walk_adaptive(t0, t1, l_son_grid, f);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_adaptive(t0, t1, l_son_grid, f);});
                         }
 					}
-					if (l_father_grid.dx1[i] != -slope_[i]) {
+					if (l_father_grid.dx1[i] != -rslope_[i]) {
 						l_son_grid.x0[i] = l_end; 
-						l_son_grid.dx0[i] = -slope_[i];
+						l_son_grid.dx0[i] = -rslope_[i];
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
                         if (call_boundary) {
-                            cilk_spawn [&]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{walk_ncores_boundary_p(t0, t1, l_son_grid, f, bf);});
                         } else {
-                            cilk_spawn [&]{walk_adaptive(t0, t1, l_son_grid, f);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{walk_adaptive(t0, t1, l_son_grid, f);});
                         }
 					}
 				}
@@ -2462,6 +2504,7 @@ inline void Algorithm<N_RANK>::walk_ncores_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+	Pochoir_Task_Group l_tg;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2471,7 +2514,7 @@ inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> con
 
 	for (int i = 0; i < N_RANK; ++i) {
 		lb[i] = grid.x1[i] - grid.x0[i];
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 	}	
 	for (int i = N_RANK-1; i >= 0; --i) {
 		if (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]) { 
@@ -2482,36 +2525,36 @@ inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> con
 			printf("initial_cut = %s, lb[%d] = %d, sep = %d, r = %d\n", initial_cut(i) ? "True" : "False", i, lb[i], sep, r);
 #endif
 			l_grid.x0[i] = grid.x0[i];
-			l_grid.dx0[i] = slope_[i];
+			l_grid.dx0[i] = lslope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
-			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn [&]{obase_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = -rslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{obase_bicut(t0, t1, l_grid, f);});
 
 			l_grid.x0[i] = grid.x0[i] + sep;
-			l_grid.dx0[i] = slope_[i];
+			l_grid.dx0[i] = lslope_[i];
 			l_grid.x1[i] = grid.x1[i];
-			l_grid.dx1[i] = -slope_[i];
-			cilk_spawn [&]{obase_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = -rslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{obase_bicut(t0, t1, l_grid, f);});
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
-			if (grid.dx0[i] != slope_[i]) {
+			pochoir_sync(l_tg);
+			if (grid.dx0[i] != lslope_[i]) {
 				l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-				cilk_spawn [&]{obase_bicut(t0, t1, l_grid, f);}();
+				l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = lslope_[i];
+				pochoir_spawn(l_tg, [=, &f]{obase_bicut(t0, t1, l_grid, f);});
 			}
 
 			l_grid.x0[i] = grid.x0[i] + sep;
-			l_grid.dx0[i] = -slope_[i];
+			l_grid.dx0[i] = -rslope_[i];
 			l_grid.x1[i] = grid.x0[i] + sep;
-			l_grid.dx1[i] = slope_[i];
-			cilk_spawn [&]{obase_bicut(t0, t1, l_grid, f);}();
+			l_grid.dx1[i] = lslope_[i];
+			pochoir_spawn(l_tg, [=, &f]{obase_bicut(t0, t1, l_grid, f);});
 
-			if (grid.dx1[i] != -slope_[i]) {
-				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
+			if (grid.dx1[i] != -rslope_[i]) {
+				l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -rslope_[i];
 				l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-				cilk_spawn [&]{obase_bicut(t0, t1, l_grid, f);}();
+				pochoir_spawn(l_tg, [=, &f]{obase_bicut(t0, t1, l_grid, f);});
 			}
 #if DEBUG
 			printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2553,6 +2596,7 @@ inline void Algorithm<N_RANK>::obase_bicut(int t0, int t1, grid_info<N_RANK> con
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+	Pochoir_Task_Group l_tg;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2569,7 +2613,7 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 		lb[i] = grid.x1[i] - grid.x0[i];
         tb[i] = (grid.x1[i] + grid.dx1[i] * lt) - (grid.x0[i] + grid.dx0[i] * lt);
         cut_lb[i] = (grid.dx0[i] >= 0 && grid.dx1[i] <= 0);
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 		base_cube = base_cube && (lb[i] <= dx_recursive_[i] || lb[i] < thres[i]); 
 	}	
 	if (base_cube) {
@@ -2583,7 +2627,7 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 		for (int i = N_RANK-1; i >= 0 && !cut_yet; --i) {
 			if (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]) { 
 				l_grid = grid;
-				int sep = (2 * slope_[i] * lt);
+				int sep = ((lslope_[i] + rslope_[i]) * lt);
 				int r = (lb[i]/sep);
 #if DEBUG
 				printf("initial_cut = %s, lb[%d] = %d, sep = %d, r = %d\n", initial_cut(i) ? "True" : "False", i, lb[i], sep, r);
@@ -2591,37 +2635,37 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = slope_[i];
+					l_grid.dx0[i] = lslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
-					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn [&]{obase_m(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = -rslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_m(t0, t1, l_grid, f);});
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
-				l_grid.dx0[i] = slope_[i];
+				l_grid.dx0[i] = lslope_[i];
 				l_grid.x1[i] = grid.x1[i];
-				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn [&]{obase_m(t0, t1, l_grid, f);}();
+				l_grid.dx1[i] = -rslope_[i];
+				pochoir_spawn(l_tg, [=, &f]{obase_m(t0, t1, l_grid, f);});
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
-				if (grid.dx0[i] != slope_[i]) {
+				pochoir_sync(l_tg);
+				if (grid.dx0[i] != lslope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{obase_m(t0, t1, l_grid, f);}();
+					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_m(t0, t1, l_grid, f);});
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = -slope_[i];
+					l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
-					l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{base_m(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_m(t0, t1, l_grid, f);});
 				}
-				if (grid.dx1[i] != -slope_[i]) {
-					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
+				if (grid.dx1[i] != -rslope_[i]) {
+					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn [&]{obase_m(t0, t1, l_grid, f);}();
+					pochoir_spawn(l_tg, [=, &f]{obase_m(t0, t1, l_grid, f);});
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2659,6 +2703,7 @@ inline void Algorithm<N_RANK>::obase_m(int t0, int t1, grid_info<N_RANK> const g
 template <int N_RANK> template <typename F>
 inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK> const grid, F const & f)
 {
+	Pochoir_Task_Group l_tg;
 	/* for the initial cut on each dimension, cut into exact N_CORES pieces,
 	   for the rest cut into that dimension, cut into as many as we can!
 	 */
@@ -2672,7 +2717,7 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 
 	for (int i = 0; i < N_RANK; ++i) {
 		lb[i] = grid.x1[i] - grid.x0[i];
-		thres[i] = (initial_cut(i)) ? N_CORES * (2 * slope_[i] * lt) : 2 * (2 * slope_[i] * lt);
+		thres[i] = (initial_cut(i)) ? N_CORES * ((lslope_[i] + rslope_[i]) * lt) : 2 * ((lslope_[i] + rslope_[i]) * lt);
 		base_cube = base_cube && (lb[i] <= dx_recursive_[i] || lb[i] < thres[i]); 
 	}	
 	if (base_cube) {
@@ -2686,7 +2731,7 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 		for (int i = N_RANK-1; i >= 0 && !cut_yet; --i) {
 			if (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]) { 
 				l_grid = grid;
-				int sep = (initial_cut(i)) ? lb[i]/N_CORES : (2 * slope_[i] * lt);
+				int sep = (initial_cut(i)) ? lb[i]/N_CORES : ((lslope_[i] + rslope_[i]) * lt);
 				int r = (initial_cut(i)) ? N_CORES : (lb[i]/sep);
 #if DEBUG
 				printf("initial_cut = %s, lb[%d] = %d, sep = %d, r = %d\n", initial_cut(i) ? "True" : "False", i, lb[i], sep, r);
@@ -2694,37 +2739,37 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = slope_[i];
+					l_grid.dx0[i] = lslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * (j+1);
-					l_grid.dx1[i] = -slope_[i];
-					cilk_spawn [&]{obase_adaptive(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = -rslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_adaptive(t0, t1, l_grid, f);});
 				}
 	//			j_loc = r-1;
 				l_grid.x0[i] = grid.x0[i] + sep * (r-1);
-				l_grid.dx0[i] = slope_[i];
+				l_grid.dx0[i] = lslope_[i];
 				l_grid.x1[i] = grid.x1[i];
-				l_grid.dx1[i] = -slope_[i];
-				cilk_spawn [&]{obase_adaptive(t0, t1, l_grid, f);}();
+				l_grid.dx1[i] = -rslope_[i];
+				pochoir_spawn(l_tg, [=, &f]{obase_adaptive(t0, t1, l_grid, f);});
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
-				if (grid.dx0[i] != slope_[i]) {
+				pochoir_sync(l_tg);
+				if (grid.dx0[i] != lslope_[i]) {
 					l_grid.x0[i] = grid.x0[i]; l_grid.dx0[i] = grid.dx0[i];
-					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{obase_adaptive(t0, t1, l_grid, f);}();
+					l_grid.x1[i] = grid.x0[i]; l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_adaptive(t0, t1, l_grid, f);});
 				}
 				for (int j = 1; j < r; ++j) {
 					l_grid.x0[i] = grid.x0[i] + sep * j;
-					l_grid.dx0[i] = -slope_[i];
+					l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x0[i] + sep * j;
-					l_grid.dx1[i] = slope_[i];
-					cilk_spawn [&]{obase_adaptive(t0, t1, l_grid, f);}();
+					l_grid.dx1[i] = lslope_[i];
+					pochoir_spawn(l_tg, [=, &f]{obase_adaptive(t0, t1, l_grid, f);});
 				}
-				if (grid.dx1[i] != -slope_[i]) {
-					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -slope_[i];
+				if (grid.dx1[i] != -rslope_[i]) {
+					l_grid.x0[i] = grid.x1[i]; l_grid.dx0[i] = -rslope_[i];
 					l_grid.x1[i] = grid.x1[i]; l_grid.dx1[i] = grid.dx1[i];
-					cilk_spawn [&]{obase_adaptive(t0, t1, l_grid, f);}();
+					pochoir_spawn(l_tg, [=, &f]{obase_adaptive(t0, t1, l_grid, f);});
 				}
 #if 0
 				printf("%s:%d cut into %d dim\n", __FUNCTION__, __LINE__, i);
@@ -2762,6 +2807,7 @@ inline void Algorithm<N_RANK>::obase_adaptive(int t0, int t1, grid_info<N_RANK>
 template <int N_RANK> template <typename BF>
 inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2773,7 +2819,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 		call_boundary = call_boundary || l_touch_boundary[i];
 	}	
 
@@ -2788,46 +2834,46 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 			int j;
 
 			l_son_grid.x0[i] = l_start;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = -slope_[i];
-            cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);}();
+			l_son_grid.dx1[i] = -rslope_[i];
+            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);});
 
 			l_son_grid.x0[i] = l_start + sep * j;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_end;
-			l_son_grid.dx1[i] = -slope_[i];
+			l_son_grid.dx1[i] = -rslope_[i];
             obase_bicut_boundary_p(t0, t1, l_son_grid, bf);
 #if DEBUG
 //			print_sync(stdout);
 #endif
-			cilk_sync;
+			pochoir_sync(l_tg);
 			l_son_grid.x0[i] = l_start + sep;
-			l_son_grid.dx0[i] = -slope_[i];
+			l_son_grid.dx0[i] = -rslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = slope_[i];
-            cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);}();
-			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+			l_son_grid.dx1[i] = lslope_[i];
+            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);});
+			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
         //        printf("merge triagles!\n");
 				l_son_grid.x0[i] = l_end;
-				l_son_grid.dx0[i] = -slope_[i];
+				l_son_grid.dx0[i] = -rslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = slope_[i];
-                cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);}();
+				l_son_grid.dx1[i] = lslope_[i];
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);});
 			} else {
-				if (l_father_grid.dx0[i] != slope_[i]) {
+				if (l_father_grid.dx0[i] != lslope_[i]) {
 					l_son_grid.x0[i] = l_start; 
 					l_son_grid.dx0[i] = l_father_grid.dx0[i];
 					l_son_grid.x1[i] = l_start; 
-					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);}();
+					l_son_grid.dx1[i] = lslope_[i];
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);});
 				}
-				if (l_father_grid.dx1[i] != -slope_[i]) {
+				if (l_father_grid.dx1[i] != -rslope_[i]) {
 					l_son_grid.x0[i] = l_end; 
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
-                    cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);}();
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, bf);});
 				}
 			}
             return;
@@ -2858,6 +2904,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename BF>
 inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2870,7 +2917,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = (initial_cut(i)) ?  N_CORES * (2 * slope_[i] * lt) : 2 * (2 * slope_[i] * lt);
+		thres[i] = (initial_cut(i)) ?  N_CORES * ((lslope_[i] + rslope_[i]) * lt) : 2 * ((lslope_[i] + rslope_[i]) * lt);
 		if (l_touch_boundary[i])
 			base_cube = base_cube && (lb[i] <= dx_recursive_boundary_[i] || lb[i] < thres[i]); 
 		else 
@@ -2886,7 +2933,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 			can_cut = (l_touch_boundary[i]) ? (lb[i] >= thres[i] && lb[i] > dx_recursive_boundary_[i]) : (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]);
 			if (can_cut) { 
 				l_son_grid = l_father_grid;
-                int sep = (initial_cut(i)) ? lb[i]/N_CORES : (2 * slope_[i] * lt);
+                int sep = (initial_cut(i)) ? lb[i]/N_CORES : ((lslope_[i] + rslope_[i]) * lt);
                 //int r = (initial_cut(i)) ? N_CORES : (lb[i]/sep);
                 int r = lb[i]/sep;
 				int l_start = (l_father_grid.x0[i]);
@@ -2894,48 +2941,48 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = slope_[i];
+					l_son_grid.dx0[i] = lslope_[i];
 					l_son_grid.x1[i] = l_start + sep * (j+1);
-					l_son_grid.dx1[i] = -slope_[i];
-                    cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, bf);}();
+					l_son_grid.dx1[i] = -rslope_[i];
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_boundary_p(t0, t1, l_son_grid, bf);});
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
-				l_son_grid.dx0[i] = slope_[i];
+				l_son_grid.dx0[i] = lslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = -slope_[i];
+				l_son_grid.dx1[i] = -rslope_[i];
                 obase_boundary_p(t0, t1, l_son_grid, bf);
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync(l_tg);
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
-					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, bf);}();
+					l_son_grid.dx1[i] = lslope_[i];
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_boundary_p(t0, t1, l_son_grid, bf);});
 				}
-				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
             //        printf("merge triagles!\n");
 					l_son_grid.x0[i] = l_end;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end;
-					l_son_grid.dx1[i] = slope_[i];
-                    cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, bf);}();
+					l_son_grid.dx1[i] = lslope_[i];
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_boundary_p(t0, t1, l_son_grid, bf);});
 				} else {
-					if (l_father_grid.dx0[i] != slope_[i]) {
+					if (l_father_grid.dx0[i] != lslope_[i]) {
 						l_son_grid.x0[i] = l_start; 
 						l_son_grid.dx0[i] = l_father_grid.dx0[i];
 						l_son_grid.x1[i] = l_start; 
-						l_son_grid.dx1[i] = slope_[i];
-                        cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, bf);}();
+						l_son_grid.dx1[i] = lslope_[i];
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_boundary_p(t0, t1, l_son_grid, bf);});
 					}
-					if (l_father_grid.dx1[i] != -slope_[i]) {
+					if (l_father_grid.dx1[i] != -rslope_[i]) {
 						l_son_grid.x0[i] = l_end; 
-						l_son_grid.dx0[i] = -slope_[i];
+						l_son_grid.dx0[i] = -rslope_[i];
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
-                        cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &bf]{obase_boundary_p(t0, t1, l_son_grid, bf);});
 					}
 				}
 				cut_yet = true;
@@ -2966,6 +3013,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -2978,7 +3026,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = 2 * (2 * slope_[i] * lt);
+		thres[i] = 2 * ((lslope_[i] + rslope_[i]) * lt);
 		call_boundary = call_boundary || l_touch_boundary[i];
 	}	
 
@@ -2992,68 +3040,68 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 			int l_end = (l_father_grid.x1[i]);
 
 			l_son_grid.x0[i] = l_start;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = -slope_[i];
+			l_son_grid.dx1[i] = -rslope_[i];
             if (call_boundary) {
-                cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
             } else {
-                cilk_spawn [&]{obase_bicut(t0, t1, l_son_grid, f);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_bicut(t0, t1, l_son_grid, f);});
             }
 
 			l_son_grid.x0[i] = l_start + sep;
-			l_son_grid.dx0[i] = slope_[i];
+			l_son_grid.dx0[i] = lslope_[i];
 			l_son_grid.x1[i] = l_end;
-			l_son_grid.dx1[i] = -slope_[i];
+			l_son_grid.dx1[i] = -rslope_[i];
             if (call_boundary) {
                 obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);
             } else {
                 obase_bicut(t0, t1, l_son_grid, f);
             }
-			cilk_sync;
+			pochoir_sync(l_tg);
 
 			l_son_grid.x0[i] = l_start + sep;
-			l_son_grid.dx0[i] = -slope_[i];
+			l_son_grid.dx0[i] = -rslope_[i];
 			l_son_grid.x1[i] = l_start + sep;
-			l_son_grid.dx1[i] = slope_[i];
+			l_son_grid.dx1[i] = lslope_[i];
             if (call_boundary) {
-                cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
             } else {
-                cilk_spawn [&]{obase_bicut(t0, t1, l_son_grid, f);}();
+                pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_bicut(t0, t1, l_son_grid, f);});
             }
 
-			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+			if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
         //        printf("merge triagles!\n");
 				l_son_grid.x0[i] = l_end;
-				l_son_grid.dx0[i] = -slope_[i];
+				l_son_grid.dx0[i] = -rslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = slope_[i];
+				l_son_grid.dx1[i] = lslope_[i];
                 if (call_boundary) {
-                    cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                 } else {
-                    cilk_spawn [&]{obase_bicut(t0, t1, l_son_grid, f);}();
+                    pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_bicut(t0, t1, l_son_grid, f);});
                 }
 			} else {
-				if (l_father_grid.dx0[i] != slope_[i]) {
+				if (l_father_grid.dx0[i] != lslope_[i]) {
 					l_son_grid.x0[i] = l_start; 
 					l_son_grid.dx0[i] = l_father_grid.dx0[i];
 					l_son_grid.x1[i] = l_start; 
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{obase_bicut(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_bicut(t0, t1, l_son_grid, f);});
                     }
 				}
-				if (l_father_grid.dx1[i] != -slope_[i]) {
+				if (l_father_grid.dx1[i] != -rslope_[i]) {
 					l_son_grid.x0[i] = l_end; 
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end; 
 					l_son_grid.dx1[i] = l_father_grid.dx1[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_bicut_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{obase_bicut(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_bicut(t0, t1, l_son_grid, f);});
                     }
 				}
 			}
@@ -3110,6 +3158,7 @@ inline void Algorithm<N_RANK>::obase_bicut_boundary_p(int t0, int t1, grid_info<
 template <int N_RANK> template <typename F, typename BF>
 inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK> const grid, F const & f, BF const & bf)
 {
+	Pochoir_Task_Group l_tg;
 	/* cut into exact N_CORES pieces */
 	/* Indirect memory access is expensive */
 	int lt = t1 - t0;
@@ -3122,7 +3171,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 	for (int i = 0; i < N_RANK; ++i) {
         l_touch_boundary[i] = touch_boundary(i, lt, l_father_grid);
 		lb[i] = (l_father_grid.x1[i] - l_father_grid.x0[i]);
-		thres[i] = (initial_cut(i)) ?  N_CORES * (2 * slope_[i] * lt) : 2 * (2 * slope_[i] * lt);
+		thres[i] = (initial_cut(i)) ?  N_CORES * ((lslope_[i] + rslope_[i]) * lt) : 2 * ((lslope_[i] + rslope_[i]) * lt);
 		if (l_touch_boundary[i])
 			base_cube = base_cube && (lb[i] <= dx_recursive_boundary_[i] || lb[i] < thres[i]); 
 		else 
@@ -3154,7 +3203,7 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 			can_cut = (l_touch_boundary[i]) ? (lb[i] >= thres[i] && lb[i] > dx_recursive_boundary_[i]) : (lb[i] >= thres[i] && lb[i] > dx_recursive_[i]);
 			if (can_cut) { 
                 l_son_grid = l_father_grid;
-                int sep = (initial_cut(i)) ? lb[i]/N_CORES : (2 * slope_[i] * lt);
+                int sep = (initial_cut(i)) ? lb[i]/N_CORES : ((lslope_[i] + rslope_[i]) * lt);
                 //int r = (initial_cut(i)) ? N_CORES : (lb[i]/sep);
                 int r = lb[i]/sep;
 				int l_start = (l_father_grid.x0[i]);
@@ -3162,19 +3211,19 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 				int j;
 				for (j = 0; j < r-1; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = slope_[i];
+					l_son_grid.dx0[i] = lslope_[i];
 					l_son_grid.x1[i] = l_start + sep * (j+1);
-					l_son_grid.dx1[i] = -slope_[i];
+					l_son_grid.dx1[i] = -rslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{obase_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_adaptive(t0, t1, l_son_grid, f);});
                     }
 				}
 				l_son_grid.x0[i] = l_start + sep * j;
-				l_son_grid.dx0[i] = slope_[i];
+				l_son_grid.dx0[i] = lslope_[i];
 				l_son_grid.x1[i] = l_end;
-				l_son_grid.dx1[i] = -slope_[i];
+				l_son_grid.dx1[i] = -rslope_[i];
                 if (call_boundary) {
                     obase_boundary_p(t0, t1, l_son_grid, f, bf);
                 } else {
@@ -3183,50 +3232,50 @@ inline void Algorithm<N_RANK>::obase_boundary_p(int t0, int t1, grid_info<N_RANK
 #if DEBUG
 //				print_sync(stdout);
 #endif
-				cilk_sync;
+				pochoir_sync(l_tg);
 				for (j = 1; j < r; ++j) {
 					l_son_grid.x0[i] = l_start + sep * j;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_start + sep * j;
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{obase_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_adaptive(t0, t1, l_son_grid, f);});
                     }
 				}
-				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i]) {
+				if (l_start == phys_grid_.x0[i] && l_end == phys_grid_.x1[i] && wraps(i)) {
             //        printf("merge triagles!\n");
 					l_son_grid.x0[i] = l_end;
-					l_son_grid.dx0[i] = -slope_[i];
+					l_son_grid.dx0[i] = -rslope_[i];
 					l_son_grid.x1[i] = l_end;
-					l_son_grid.dx1[i] = slope_[i];
+					l_son_grid.dx1[i] = lslope_[i];
                     if (call_boundary) {
-                        cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_boundary_p(t0, t1, l_son_grid, f, bf);});
                     } else {
-                        cilk_spawn [&]{obase_adaptive(t0, t1, l_son_grid, f);}();
+                        pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_adaptive(t0, t1, l_son_grid, f);});
                     }
 				} else {
-					if (l_father_grid.dx0[i] != slope_[i]) {
+					if (l_father_grid.dx0[i] != lslope_[i]) {
 						l_son_grid.x0[i] = l_start; 
 						l_son_grid.dx0[i] = l_father_grid.dx0[i];
 						l_son_grid.x1[i] = l_start; 
-						l_son_grid.dx1[i] = slope_[i];
+						l_son_grid.dx1[i] = lslope_[i];
                         if (call_boundary) {
-                            cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_boundary_p(t0, t1, l_son_grid, f, bf);});
                         } else {
-                            cilk_spawn [&]{obase_adaptive(t0, t1, l_son_grid, f);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_adaptive(t0, t1, l_son_grid, f);});
                         }
 					}
-					if (l_father_grid.dx1[i] != -slope_[i]) {
+					if (l_father_grid.dx1[i] != -rslope_[i]) {
 						l_son_grid.x0[i] = l_end; 
-						l_son_grid.dx0[i] = -slope_[i];
+						l_son_grid.dx0[i] = -rslope_[i];
 						l_son_grid.x1[i] = l_end; 
 						l_son_grid.dx1[i] = l_father_grid.dx1[i];
                         if (call_boundary) {
-                            cilk_spawn [&]{obase_boundary_p(t0, t1, l_son_grid, f, bf);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f, &bf]{obase_boundary_p(t0, t1, l_son_grid, f, bf);});
                         } else {
-                            cilk_spawn [&]{obase_adaptive(t0, t1, l_son_grid, f);}();
+                            pochoir_spawn_near(l_tg, home(l_son_grid), phys_length_[N_RANK-1], [=, &f]{obase_adaptive(t0, t1, l_son_grid, f);});
                         }
 					}
 				}